@@ -14,20 +14,30 @@
 #include <ArduinoOcpp/Tasks/Diagnostics/DiagnosticsService.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/ThreadedOcppSocket.h>
 
 #include <ArduinoOcpp/MessagesV16/Authorize.h>
 #include <ArduinoOcpp/MessagesV16/BootNotification.h>
 #include <ArduinoOcpp/MessagesV16/StartTransaction.h>
 #include <ArduinoOcpp/MessagesV16/StopTransaction.h>
+#include <ArduinoOcpp/MessagesV16/DataTransfer.h>
 
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 namespace ArduinoOcpp {
 namespace Facade {
 
 #ifndef AO_CUSTOM_WS
 WebSocketsClient *webSocket {nullptr};
 OcppSocket *ocppSocket {nullptr};
+#ifdef AO_THREADED_IO
+#ifndef AO_THREADED_SOCKET_SUPPORTED
+#error AO_THREADED_IO requires the ESP32 or a POSIX platform
+#endif
+OcppSocket *ioSocket {nullptr}; //the socket on the I/O thread. ocppSocket wraps it
+#endif
 #endif
 
 OcppEngine *ocppEngine {nullptr};
@@ -46,6 +56,51 @@ using namespace ArduinoOcpp;
 using namespace ArduinoOcpp::Facade;
 using namespace ArduinoOcpp::Ocpp16;
 
+namespace ArduinoOcpp {
+namespace Facade {
+
+/*
+ * Applies a facade call to the engine. With AO_COMMAND_QUEUE, the call is enqueued and executed at the beginning
+ * of the next OCPP_loop(), so that other tasks can use the facade without locking. Otherwise, it runs immediately
+ */
+void runOnEngine(std::function<void()> command) {
+#ifdef AO_COMMAND_QUEUE
+    ocppEngine->post(std::move(command));
+#else
+    command();
+#endif
+}
+
+/*
+ * Builds an operation and initiates it on the engine. The message, the operation and the default timeout are created
+ * within the command, i.e. on the engine thread with AO_COMMAND_QUEUE. The calling thread only copies the arguments
+ */
+void initiateOnEngine(std::function<OcppMessage*()> makeMessage, OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout, std::function<Timeout*()> makeDefaultTimeout) {
+    auto customTimeout = std::make_shared<std::unique_ptr<Timeout>>(std::move(timeout)); //std::function must be copyable
+    runOnEngine([makeMessage, onConf, onAbort, onTimeout, onError, customTimeout, makeDefaultTimeout] () {
+        auto op = makeOcppOperation(makeMessage());
+        if (!op) {
+            return;
+        }
+        if (onConf)
+            op->setOnReceiveConfListener(onConf);
+        if (onAbort)
+            op->setOnAbortListener(onAbort);
+        if (onTimeout)
+            op->setOnTimeoutListener(onTimeout);
+        if (onError)
+            op->setOnReceiveErrorListener(onError);
+        if (*customTimeout)
+            op->setTimeout(std::move(*customTimeout));
+        else
+            op->setTimeout(std::unique_ptr<Timeout>(makeDefaultTimeout()));
+        ocppEngine->initiateOperation(std::move(op));
+    });
+}
+
+} //end namespace ArduinoOcpp::Facade
+} //end namespace ArduinoOcpp
+
 #ifndef AO_CUSTOM_WS
 void OCPP_initialize(const char *CS_hostname, uint16_t CS_port, const char *CS_url, float V_eff, ArduinoOcpp::FilesystemOpt fsOpt, ArduinoOcpp::OcppClock system_time) {
     if (ocppEngine) {
@@ -69,7 +124,13 @@ void OCPP_initialize(const char *CS_hostname, uint16_t CS_port, const char *CS_u
     webSocket->enableHeartbeat(15000, 3000, 2); //comment this one out to for specific OCPP servers
 
     delete ocppSocket;
+#ifdef AO_THREADED_IO
+    delete ioSocket;
+    ioSocket = new EspWiFi::OcppClientSocket(webSocket);
+    ocppSocket = new ThreadedOcppSocket(*ioSocket);
+#else
     ocppSocket = new EspWiFi::OcppClientSocket(webSocket);
+#endif
 
     OCPP_initialize(*ocppSocket, V_eff, fsOpt);
 }
@@ -120,14 +181,16 @@ void OCPP_deinitialize() {
     ocppEngine = nullptr;
 
 #ifndef AO_CUSTOM_WS
-    delete ocppSocket;
+    delete ocppSocket; //stops the I/O thread first
     ocppSocket = nullptr;
+#ifdef AO_THREADED_IO
+    delete ioSocket;
+    ioSocket = nullptr;
+#endif
     delete webSocket;
     webSocket = nullptr;
 #endif
 
-    simpleOcppFactory_deinitialize();
-
     fileSystemOpt = FilesystemOpt();
     voltage_eff = 230.f;
 
@@ -137,7 +200,9 @@ void OCPP_deinitialize() {
 void OCPP_loop() {
     if (!ocppEngine) {
         AO_DBG_WARN("Please call OCPP_initialize before");
+#ifdef AO_PLATFORM_ARDUINO
         delay(200); //Prevent this message from flooding the Serial monitor.
+#endif
         return;
     }
 
@@ -157,57 +222,101 @@ void OCPP_loop() {
 
 }
 
-void setPowerActiveImportSampler(std::function<float()> power) {
+void OCPP_post(std::function<void()> command) {
     if (!ocppEngine) {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
+    runOnEngine(std::move(command));
+}
 
-    auto& model = ocppEngine->getOcppModel();
-    if (!model.getMeteringService()) {
-        model.setMeteringSerivce(std::unique_ptr<MeteringService>(
-            new MeteringService(*ocppEngine, OCPP_NUMCONNECTORS)));
+unsigned long OCPP_nextWakeupMs() {
+    if (!ocppEngine) {
+        AO_DBG_WARN("Please call OCPP_initialize before");
+        return AO_WAKEUP_NEVER;
+    }
+
+    if (!OCPP_booted) {
+        return 0; //booting is driven by OCPP_loop()
     }
-    model.getMeteringService()->setPowerSampler(OCPP_ID_OF_CONNECTOR, power); //connectorId=1
+
+    return ocppEngine->nextWakeupMs();
 }
 
-void setEnergyActiveImportSampler(std::function<float()> energy) {
+ArduinoOcpp::QueueBudgetStatus OCPP_getInitiatedQueueStatus() {
     if (!ocppEngine) {
-        AO_DBG_ERR("Please call OCPP_initialize before");
-        return;
+        AO_DBG_WARN("Please call OCPP_initialize before");
+        return ArduinoOcpp::QueueBudgetStatus();
     }
-    auto& model = ocppEngine->getOcppModel();
-    if (!model.getMeteringService()) {
-        model.setMeteringSerivce(std::unique_ptr<MeteringService>(
-            new MeteringService(*ocppEngine, OCPP_NUMCONNECTORS)));
+    return ocppEngine->getInitiatedBudgetStatus();
+}
+
+ArduinoOcpp::QueueBudgetStatus OCPP_getReceivedQueueStatus() {
+    if (!ocppEngine) {
+        AO_DBG_WARN("Please call OCPP_initialize before");
+        return ArduinoOcpp::QueueBudgetStatus();
     }
-    model.getMeteringService()->setEnergySampler(OCPP_ID_OF_CONNECTOR, energy); //connectorId=1
+    return ocppEngine->getReceivedBudgetStatus();
 }
 
-void setEvRequestsEnergySampler(std::function<bool()> evRequestsEnergy) {
+void setPowerActiveImportSampler(std::function<float()> power) {
     if (!ocppEngine) {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
+    runOnEngine([power] () {
+        auto& model = ocppEngine->getOcppModel();
+        if (!model.getMeteringService()) {
+            model.setMeteringSerivce(std::unique_ptr<MeteringService>(
+                new MeteringService(*ocppEngine, OCPP_NUMCONNECTORS)));
+        }
+        model.getMeteringService()->setPowerSampler(OCPP_ID_OF_CONNECTOR, power); //connectorId=1
+    });
+}
+
+void setEnergyActiveImportSampler(std::function<float()> energy) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    connector->setEvRequestsEnergySampler(evRequestsEnergy);
+    runOnEngine([energy] () {
+        auto& model = ocppEngine->getOcppModel();
+        if (!model.getMeteringService()) {
+            model.setMeteringSerivce(std::unique_ptr<MeteringService>(
+                new MeteringService(*ocppEngine, OCPP_NUMCONNECTORS)));
+        }
+        model.getMeteringService()->setEnergySampler(OCPP_ID_OF_CONNECTOR, energy); //connectorId=1
+    });
 }
 
-void setConnectorEnergizedSampler(std::function<bool()> connectorEnergized) {
+void setEvRequestsEnergySampler(std::function<bool()> evRequestsEnergy) {
     if (!ocppEngine) {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
+    runOnEngine([evRequestsEnergy] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->setEvRequestsEnergySampler(evRequestsEnergy);
+    });
+}
+
+void setConnectorEnergizedSampler(std::function<bool()> connectorEnergized) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    connector->setConnectorEnergizedSampler(connectorEnergized);
+    runOnEngine([connectorEnergized] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->setConnectorEnergizedSampler(connectorEnergized);
+    });
 }
 
 void setConnectorPluggedSampler(std::function<bool()> connectorPlugged) {
@@ -215,12 +324,14 @@ void setConnectorPluggedSampler(std::function<bool()> connectorPlugged) {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
-        return;
-    }
-    connector->setConnectorPluggedSampler(connectorPlugged);
+    runOnEngine([connectorPlugged] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->setConnectorPluggedSampler(connectorPlugged);
+    });
 }
 
 void addConnectorErrorCodeSampler(std::function<const char *()> connectorErrorCode) {
@@ -228,12 +339,14 @@ void addConnectorErrorCodeSampler(std::function<const char *()> connectorErrorCo
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
-        return;
-    }
-    connector->addConnectorErrorCodeSampler(connectorErrorCode);
+    runOnEngine([connectorErrorCode] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->addConnectorErrorCodeSampler(connectorErrorCode);
+    });
 }
 
 void setOnChargingRateLimitChange(std::function<void(float)> chargingRateChanged) {
@@ -241,12 +354,14 @@ void setOnChargingRateLimitChange(std::function<void(float)> chargingRateChanged
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto& model = ocppEngine->getOcppModel();
-    if (!model.getSmartChargingService()) {
-        model.setSmartChargingService(std::unique_ptr<SmartChargingService>(
-            new SmartChargingService(*ocppEngine, 11000.0f, voltage_eff, OCPP_NUMCONNECTORS, fileSystemOpt))); //default charging limit: 11kW
-    }
-    model.getSmartChargingService()->setOnLimitChange(chargingRateChanged);
+    runOnEngine([chargingRateChanged] () {
+        auto& model = ocppEngine->getOcppModel();
+        if (!model.getSmartChargingService()) {
+            model.setSmartChargingService(std::unique_ptr<SmartChargingService>(
+                new SmartChargingService(*ocppEngine, 11000.0f, voltage_eff, OCPP_NUMCONNECTORS, fileSystemOpt))); //default charging limit: 11kW
+        }
+        model.getSmartChargingService()->setOnLimitChange(chargingRateChanged);
+    });
 }
 
 void setOnUnlockConnector(std::function<bool()> unlockConnector) {
@@ -254,36 +369,74 @@ void setOnUnlockConnector(std::function<bool()> unlockConnector) {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
-        return;
-    }
-    connector->setOnUnlockConnector(unlockConnector);
+    runOnEngine([unlockConnector] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->setOnUnlockConnector(unlockConnector);
+    });
 }
 
 void setOnSetChargingProfileRequest(OnReceiveReqListener onReceiveReq) {
-     setOnSetChargingProfileRequestListener(onReceiveReq);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnSetChargingProfileRequestListener(onReceiveReq);
+    });
 }
 
 void setOnRemoteStartTransactionSendConf(OnSendConfListener onSendConf) {
-    setOnRemoteStartTransactionSendConfListener(onSendConf);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnRemoteStartTransactionSendConfListener(onSendConf);
+    });
 }
 
 void setOnRemoteStopTransactionReceiveReq(OnReceiveReqListener onReceiveReq) {
-     setOnRemoteStopTransactionReceiveRequestListener(onReceiveReq);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnRemoteStopTransactionReceiveRequestListener(onReceiveReq);
+    });
 }
 
 void setOnRemoteStopTransactionSendConf(OnSendConfListener onSendConf) {
-     setOnRemoteStopTransactionSendConfListener(onSendConf);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnRemoteStopTransactionSendConfListener(onSendConf);
+    });
 }
 
 void setOnResetSendConf(OnSendConfListener onSendConf) {
-     setOnResetSendConfListener(onSendConf);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnResetSendConfListener(onSendConf);
+    });
 }
 
 void setOnResetReceiveReq(OnReceiveReqListener onReceiveReq) {
-     setOnResetReceiveRequestListener(onReceiveReq);
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnResetReceiveRequestListener(onReceiveReq);
+    });
 }
 
 void authorize(const char *idTag, OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
@@ -295,21 +448,12 @@ void authorize(const char *idTag, OnReceiveConfListener onConf, OnAbortListener
         AO_DBG_ERR("idTag format violation. Expect c-style string with at most %u characters", IDTAG_LEN_MAX);
         return;
     }
-    auto authorize = makeOcppOperation(
-        new Authorize(idTag));
-    if (onConf)
-        authorize->setOnReceiveConfListener(onConf);
-    if (onAbort)
-        authorize->setOnAbortListener(onAbort);
-    if (onTimeout)
-        authorize->setOnTimeoutListener(onTimeout);
-    if (onError)
-        authorize->setOnReceiveErrorListener(onError);
-    if (timeout)
-        authorize->setTimeout(std::move(timeout));
-    else
-        authorize->setTimeout(std::unique_ptr<Timeout>(new FixedTimeout(20000)));
-    ocppEngine->initiateOperation(std::move(authorize));
+    std::string idTagCopy = idTag;
+    initiateOnEngine([idTagCopy] () -> OcppMessage* {
+            return new Authorize(idTagCopy.c_str());
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new FixedTimeout(20000);
+        });
 }
 
 void bootNotification(const char *chargePointModel, const char *chargePointVendor, OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
@@ -317,21 +461,13 @@ void bootNotification(const char *chargePointModel, const char *chargePointVendo
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto bootNotification = makeOcppOperation(
-        new BootNotification(chargePointModel, chargePointVendor));
-    if (onConf)
-        bootNotification->setOnReceiveConfListener(onConf);
-    if (onAbort)
-        bootNotification->setOnAbortListener(onAbort);
-    if (onTimeout)
-        bootNotification->setOnTimeoutListener(onTimeout);
-    if (onError)
-        bootNotification->setOnReceiveErrorListener(onError);
-    if (timeout)
-        bootNotification->setTimeout(std::move(timeout));
-    else
-        bootNotification->setTimeout(std::unique_ptr<Timeout> (new SuppressedTimeout()));
-    ocppEngine->initiateOperation(std::move(bootNotification));
+    std::string modelCopy = chargePointModel ? chargePointModel : "";
+    std::string vendorCopy = chargePointVendor ? chargePointVendor : "";
+    initiateOnEngine([modelCopy, vendorCopy] () -> OcppMessage* {
+            return new BootNotification(modelCopy.c_str(), vendorCopy.c_str());
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new SuppressedTimeout();
+        });
 }
 
 void bootNotification(DynamicJsonDocument *payload, OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
@@ -339,21 +475,12 @@ void bootNotification(DynamicJsonDocument *payload, OnReceiveConfListener onConf
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto bootNotification = makeOcppOperation(
-        new BootNotification(payload));
-    if (onConf)
-        bootNotification->setOnReceiveConfListener(onConf);
-    if (onAbort)
-        bootNotification->setOnAbortListener(onAbort);
-    if (onTimeout)
-        bootNotification->setOnTimeoutListener(onTimeout);
-    if (onError)
-        bootNotification->setOnReceiveErrorListener(onError);
-    if (timeout)
-        bootNotification->setTimeout(std::move(timeout));
-    else
-        bootNotification->setTimeout(std::unique_ptr<Timeout>(new SuppressedTimeout()));
-    ocppEngine->initiateOperation(std::move(bootNotification));
+    auto pendingPayload = std::make_shared<std::unique_ptr<DynamicJsonDocument>>(payload); //freed if the command is discarded
+    initiateOnEngine([pendingPayload] () -> OcppMessage* {
+            return new BootNotification(pendingPayload->release());
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new SuppressedTimeout();
+        });
 }
 
 void startTransaction(const char *idTag, OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
@@ -365,21 +492,12 @@ void startTransaction(const char *idTag, OnReceiveConfListener onConf, OnAbortLi
         AO_DBG_ERR("idTag format violation. Expect c-style string with at most %u characters", IDTAG_LEN_MAX);
         return;
     }
-    auto startTransaction = makeOcppOperation(
-        new StartTransaction(OCPP_ID_OF_CONNECTOR, idTag));
-    if (onConf)
-        startTransaction->setOnReceiveConfListener(onConf);
-    if (onAbort)
-        startTransaction->setOnAbortListener(onAbort);
-    if (onTimeout)
-        startTransaction->setOnTimeoutListener(onTimeout);
-    if (onError)
-        startTransaction->setOnReceiveErrorListener(onError);
-    if (timeout)
-        startTransaction->setTimeout(std::move(timeout));
-    else
-        startTransaction->setTimeout(std::unique_ptr<Timeout>(new SuppressedTimeout()));
-    ocppEngine->initiateOperation(std::move(startTransaction));
+    std::string idTagCopy = idTag;
+    initiateOnEngine([idTagCopy] () -> OcppMessage* {
+            return new StartTransaction(OCPP_ID_OF_CONNECTOR, idTagCopy.c_str());
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new SuppressedTimeout();
+        });
 }
 
 void stopTransaction(OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
@@ -387,22 +505,28 @@ void stopTransaction(OnReceiveConfListener onConf, OnAbortListener onAbort, OnTi
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto stopTransaction = makeOcppOperation(
-        new StopTransaction(OCPP_ID_OF_CONNECTOR));
-    if (onConf)
-        stopTransaction->setOnReceiveConfListener(onConf);
-    if (onAbort)
-        stopTransaction->setOnAbortListener(onAbort);
-    if (onTimeout)
-        stopTransaction->setOnTimeoutListener(onTimeout);
-    if (onError)
-        stopTransaction->setOnReceiveErrorListener(onError);
-    if (timeout)
-        stopTransaction->setTimeout(std::move(timeout));
-    else
-        stopTransaction->setTimeout(std::unique_ptr<Timeout>(new SuppressedTimeout()));
-    ocppEngine->initiateOperation(std::move(stopTransaction));
+    initiateOnEngine([] () -> OcppMessage* {
+            return new StopTransaction(OCPP_ID_OF_CONNECTOR);
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new SuppressedTimeout();
+        });
+}
+
+#ifdef AO_OPERATION_METRICS
+void reportOperationMetrics(OnReceiveConfListener onConf, OnAbortListener onAbort, OnTimeoutListener onTimeout, OnReceiveErrorListener onError, std::unique_ptr<Timeout> timeout) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    initiateOnEngine([] () -> OcppMessage* {
+            std::string metrics; //the snapshot is taken on the engine thread which updates the metrics
+            ArduinoOcpp::OperationMetrics::serialize(metrics);
+            return new DataTransfer(metrics, "OperationMetrics");
+        }, onConf, onAbort, onTimeout, onError, std::move(timeout), [] () -> Timeout* {
+            return new FixedTimeout(20000);
+        });
 }
+#endif
 
 int getTransactionId() {
     if (!ocppEngine) {
@@ -455,12 +579,15 @@ void beginSession(const char *idTag) {
         AO_DBG_ERR("idTag format violation. Expect c-style string with at most %u characters", IDTAG_LEN_MAX);
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
-        return;
-    }
-    connector->beginSession(idTag);
+    std::string idTagCopy = idTag; //the caller's buffer may be gone when the command is executed
+    runOnEngine([idTagCopy] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->beginSession(idTagCopy.c_str());
+    });
 }
 
 void endSession() {
@@ -468,12 +595,14 @@ void endSession() {
         AO_DBG_ERR("Please call OCPP_initialize before");
         return;
     }
-    auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
-    if (!connector) {
-        AO_DBG_ERR("Could not find connector. Ignore");
-        return;
-    }
-    connector->endSession();
+    runOnEngine([] () {
+        auto connector = ocppEngine->getOcppModel().getConnectorStatus(OCPP_ID_OF_CONNECTOR);
+        if (!connector) {
+            AO_DBG_ERR("Could not find connector. Ignore");
+            return;
+        }
+        connector->endSession();
+    });
 }
 
 bool isInSession() {
@@ -506,3 +635,221 @@ ArduinoOcpp::DiagnosticsService *getDiagnosticsService() {
     return model.getDiagnosticsService();
 }
 #endif
+
+/*
+ * Deprecated free functions of the former global operation factory (see SimpleOcppOperationFactory.h). They
+ * forward to the operation factory of the facade engine
+ */
+namespace ArduinoOcpp {
+
+std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& request) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return nullptr;
+    }
+    return ocppEngine->getOperationFactory().makeFromJson(request);
+}
+
+std::unique_ptr<OcppOperation> makeOcppOperation(const char *actionCode, int connectorId) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return nullptr;
+    }
+    return ocppEngine->getOperationFactory().makeOcppOperation(actionCode, connectorId);
+}
+
+void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([messageType, ocppMessageCreator, onReceiveReq] () {
+        ocppEngine->getOperationFactory().registerCustomOcppMessage(messageType, ocppMessageCreator, onReceiveReq);
+    });
+}
+
+void setOnAuthorizeRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnAuthorizeRequestListener(onReceiveReq);
+    });
+}
+
+void setOnBootNotificationRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnBootNotificationRequestListener(onReceiveReq);
+    });
+}
+
+void setOnTargetValuesRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnTargetValuesRequestListener(onReceiveReq);
+    });
+}
+
+void setOnSetChargingProfileRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnSetChargingProfileRequestListener(onReceiveReq);
+    });
+}
+
+void setOnStartTransactionRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnStartTransactionRequestListener(onReceiveReq);
+    });
+}
+
+void setOnTriggerMessageRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnTriggerMessageRequestListener(onReceiveReq);
+    });
+}
+
+void setOnRemoteStartTransactionReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnRemoteStartTransactionReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnRemoteStartTransactionSendConfListener(OnSendConfListener onSendConf) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnRemoteStartTransactionSendConfListener(onSendConf);
+    });
+}
+
+void setOnRemoteStopTransactionReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnRemoteStopTransactionReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnRemoteStopTransactionSendConfListener(OnSendConfListener onSendConf) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnRemoteStopTransactionSendConfListener(onSendConf);
+    });
+}
+
+void setOnChangeConfigurationReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnChangeConfigurationReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnChangeConfigurationSendConfListener(OnSendConfListener onSendConf) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnChangeConfigurationSendConfListener(onSendConf);
+    });
+}
+
+void setOnGetConfigurationReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnGetConfigurationReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnGetConfigurationSendConfListener(OnSendConfListener onSendConf) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnGetConfigurationSendConfListener(onSendConf);
+    });
+}
+
+void setOnResetReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnResetReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnResetSendConfListener(OnSendConfListener onSendConf) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onSendConf] () {
+        ocppEngine->getOperationFactory().setOnResetSendConfListener(onSendConf);
+    });
+}
+
+void setOnUpdateFirmwareReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnUpdateFirmwareReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void setOnMeterValuesReceiveRequestListener(OnReceiveReqListener onReceiveReq) {
+    if (!ocppEngine) {
+        AO_DBG_ERR("Please call OCPP_initialize before");
+        return;
+    }
+    runOnEngine([onReceiveReq] () {
+        ocppEngine->getOperationFactory().setOnMeterValuesReceiveRequestListener(onReceiveReq);
+    });
+}
+
+void simpleOcppFactory_deinitialize() {
+    //the listeners and custom messages are released by OCPP_deinitialize()
+}
+
+} //end namespace ArduinoOcpp
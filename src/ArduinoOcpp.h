@@ -14,6 +14,11 @@
 #include <ArduinoOcpp/Core/OcppOperationCallbacks.h>
 #include <ArduinoOcpp/Core/OcppOperationTimeout.h>
 #include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Core/MemoryBudget.h>
+#include <ArduinoOcpp/Core/HeapProfile.h> //with build flag AO_HEAP_PROFILE: ArduinoOcpp::HeapProfile::dump() etc.
+#include <ArduinoOcpp/Core/OperationMetrics.h> //with build flag AO_OPERATION_METRICS: ArduinoOcpp::OperationMetrics::dump() etc.
+#include <ArduinoOcpp/Core/ObjectPool.h> //ArduinoOcpp::Pools::dump() etc.
+#include <ArduinoOcpp/Platform.h>
 
 using ArduinoOcpp::OnReceiveConfListener;
 using ArduinoOcpp::OnReceiveReqListener;
@@ -37,6 +42,35 @@ void OCPP_deinitialize();
 
 void OCPP_loop();
 
+/*
+ * Thread safety: by default, the facade must be used from the thread which calls OCPP_loop(). With the build flag
+ * AO_COMMAND_QUEUE, the functions which change the state of the library (the sampler and listener setters,
+ * authorize(), startTransaction(), beginSession() etc.) may be called from any thread. They only copy their arguments
+ * and enqueue the call into a lock-free queue which is applied at the beginning of the next OCPP_loop(). The OCPP
+ * messages and operations are built on the engine thread. Each call still allocates one queue node on the calling
+ * thread. The getters are not covered; read them from within OCPP_post() instead.
+ * 
+ * OCPP_post() executes the command on the engine thread. Results can be handed back from within the command, e.g.
+ *     OCPP_post([] () {reportTxId(getTransactionId());});
+ * Without AO_COMMAND_QUEUE, the command is executed immediately
+ */
+void OCPP_post(std::function<void()> command);
+
+/*
+ * Time in ms until OCPP_loop() needs to be called again, so that the host can sleep in between. Returns 0 if
+ * there is pending work and AO_WAKEUP_NEVER if no timer is running. The WebSocket still needs to be serviced while
+ * sleeping, and when a sampler changes (e.g. the EV gets plugged), the host should call OCPP_loop() right away
+ */
+unsigned long OCPP_nextWakeupMs();
+
+/*
+ * Memory budget of the operation queues. The quotas are the configurations AO_INITIATED_OPS_MAX / _BYTES and
+ * AO_RECEIVED_OPS_MAX / _BYTES. If a queue is saturated, new operations are rejected or displace older ones which
+ * haven't been sent yet. The onAbort listener of each affected operation is called
+ */
+ArduinoOcpp::QueueBudgetStatus OCPP_getInitiatedQueueStatus();
+ArduinoOcpp::QueueBudgetStatus OCPP_getReceivedQueueStatus();
+
 /*
  * Provide hardware-related information to the library
  * 
@@ -128,6 +162,11 @@ void startTransaction(const char *idTag, OnReceiveConfListener onConf = nullptr,
 
 void stopTransaction(OnReceiveConfListener onConf = nullptr, OnAbortListener onAbort = nullptr, OnTimeoutListener onTimeout = nullptr, OnReceiveErrorListener onError = nullptr, std::unique_ptr<Timeout> timeout = nullptr);
 
+#ifdef AO_OPERATION_METRICS
+//Sends the round-trip metrics (see ArduinoOcpp/Core/OperationMetrics.h) in a DataTransfer with the messageId "OperationMetrics"
+void reportOperationMetrics(OnReceiveConfListener onConf = nullptr, OnAbortListener onAbort = nullptr, OnTimeoutListener onTimeout = nullptr, OnReceiveErrorListener onError = nullptr, std::unique_ptr<Timeout> timeout = nullptr);
+#endif
+
 /*
  * Access information about the internal state of the library
  */
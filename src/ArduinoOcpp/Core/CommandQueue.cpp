@@ -0,0 +1,39 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/CommandQueue.h>
+
+using namespace ArduinoOcpp;
+
+CommandQueue::CommandQueue() {
+    tail = new Node(); //the list always keeps one executed node as anchor
+    head.store(tail, std::memory_order_relaxed);
+}
+
+CommandQueue::~CommandQueue() {
+    while (tail) {
+        Node *next = tail->next.load(std::memory_order_relaxed);
+        delete tail;
+        tail = next;
+    }
+}
+
+void CommandQueue::push(Command command) {
+    Node *node = new Node();
+    node->command = std::move(command);
+    Node *prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release); //publishes node to the consumer
+}
+
+void CommandQueue::runAll() {
+    while (Node *next = tail->next.load(std::memory_order_acquire)) {
+        delete tail;
+        tail = next;
+        Command command = std::move(next->command); //next stays in the list as the new anchor
+        next->command = nullptr;
+        if (command) {
+            command();
+        }
+    }
+}
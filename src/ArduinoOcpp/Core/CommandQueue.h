@@ -0,0 +1,51 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef COMMANDQUEUE_H
+#define COMMANDQUEUE_H
+
+#include <atomic>
+#include <functional>
+
+namespace ArduinoOcpp {
+
+/*
+ * Lock-free multi-producer / single-consumer queue of commands (linked list after D. Vyukov). Any
+ * thread may push(); only the thread which runs the engine may call runAll().
+ * 
+ * A producer enqueues with a single atomic exchange and never waits for the consumer or other producers. If a
+ * producer is preempted in the middle of push(), its command and the commands behind it are executed by the
+ * next runAll()
+ * 
+ * push() is lock-free but not allocation-free: it allocates one node on the heap of the calling thread (plus the
+ * captures of the command if they exceed the small buffer of std::function)
+ */
+class CommandQueue {
+public:
+    using Command = std::function<void()>;
+private:
+    struct Node {
+        std::atomic<Node*> next {nullptr};
+        Command command;
+    };
+
+    std::atomic<Node*> head; //last pushed node. Producers
+    Node *tail; //already executed node. Consumer
+public:
+    CommandQueue();
+    ~CommandQueue(); //discards the pending commands without executing them
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    void push(Command command); //thread-safe
+
+    void runAll(); //executes the pending commands in the order of their push()
+
+    bool empty() {return tail->next.load(std::memory_order_acquire) == nullptr;}
+};
+
+} //end namespace ArduinoOcpp
+
+#endif
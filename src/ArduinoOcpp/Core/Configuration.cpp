@@ -3,24 +3,16 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <string.h>
 #include <vector>
 #include <ArduinoJson.h>
-
-#if defined(ESP32) && !defined(AO_DEACTIVATE_FLASH)
-#include <LITTLEFS.h>
-#define USE_FS LITTLEFS
-#else
-#include <FS.h>
-#define USE_FS SPIFFS
-#endif
+#include <algorithm>
 
 namespace ArduinoOcpp {
 
-FilesystemOpt configurationFilesystemOpt = FilesystemOpt::Use_Mount_FormatOnFail;
-
 template<class T>
 std::shared_ptr<Configuration<T>> createConfiguration(const char *key, T value) {
 
@@ -53,37 +45,34 @@ std::shared_ptr<Configuration<const char *>> createConfiguration(const char *key
     return configuration;
 }
 
-std::shared_ptr<ConfigurationContainer> createConfigurationContainer(const char *filename) {
+ConfigurationStore::ConfigurationStore(const char *pathPrefix) : pathPrefix(pathPrefix ? pathPrefix : "") {
+
+}
+
+std::shared_ptr<ConfigurationContainer> ConfigurationStore::createConfigurationContainer(const char *filename) {
+    std::string path = pathPrefix + filename;
+
     //create non-persistent Configuration store (i.e. lives only in RAM) if
     //     - Flash FS usage is switched off OR
     //     - Filename starts with "/volatile"
-    if (!configurationFilesystemOpt.accessAllowed() ||
+    if (!filesystemOpt.accessAllowed() ||
                  !strncmp(filename, CONFIGURATION_VOLATILE, strlen(CONFIGURATION_VOLATILE))) {
-        return std::static_pointer_cast<ConfigurationContainer>(std::make_shared<ConfigurationContainerVolatile>(filename));
+        return std::static_pointer_cast<ConfigurationContainer>(std::make_shared<ConfigurationContainerVolatile>(path.c_str()));
     } else {
         //create persistent Configuration store. This is the normal case
-        return std::static_pointer_cast<ConfigurationContainer>(std::make_shared<ConfigurationContainerFlash>(filename));
+        return std::static_pointer_cast<ConfigurationContainer>(std::make_shared<ConfigurationContainerFlash>(path.c_str()));
     }
 }
 
-std::vector<std::shared_ptr<ConfigurationContainer>> configurationContainers;
-
-void addConfigurationContainer(std::shared_ptr<ConfigurationContainer> container) {
+void ConfigurationStore::addConfigurationContainer(std::shared_ptr<ConfigurationContainer> container) {
     configurationContainers.push_back(container);
 }
 
-std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersBegin() {
-    return configurationContainers.begin();
-}
-
-std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersEnd() {
-    return configurationContainers.end();
-}
-
-std::shared_ptr<ConfigurationContainer> getContainer(const char *filename) {
+std::shared_ptr<ConfigurationContainer> ConfigurationStore::getContainer(const char *filename) {
+    std::string path = pathPrefix + filename;
     std::vector<std::shared_ptr<ConfigurationContainer>>::iterator container = std::find_if(configurationContainers.begin(), configurationContainers.end(),
-        [filename](std::shared_ptr<ConfigurationContainer> &elem) {
-            return !strcmp(elem->getFilename(), filename);
+        [&path](std::shared_ptr<ConfigurationContainer> &elem) {
+            return !strcmp(elem->getFilename(), path.c_str());
         });
 
     if (container != configurationContainers.end()) {
@@ -94,13 +83,13 @@ std::shared_ptr<ConfigurationContainer> getContainer(const char *filename) {
 }
 
 template<class T>
-std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged) {
+std::shared_ptr<Configuration<T>> ConfigurationStore::declareConfiguration(const char *key, T defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged) {
     //already existent? --> stored in last session --> do set default content, but set writepermission flag
     
     std::shared_ptr<ConfigurationContainer> container = getContainer(filename);
     
     if (!container) {
-        AO_DBG_INFO("init new configurations container: %s", filename);
+        AO_DBG_INFO("init new configurations container: %s%s", pathPrefix.c_str(), filename);
 
         container = createConfigurationContainer(filename);
         configurationContainers.push_back(container);
@@ -148,9 +137,7 @@ std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaul
     return configurationConcrete;
 }
 
-namespace Ocpp16 {
-
-std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key) {
+std::shared_ptr<AbstractConfiguration> ConfigurationStore::getConfiguration(const char *key) {
     std::shared_ptr<AbstractConfiguration> result = nullptr;
 
     for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
@@ -161,7 +148,7 @@ std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key) {
     return nullptr;
 }
 
-std::shared_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> getAllConfigurations() { //TODO maybe change to iterator?
+std::shared_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> ConfigurationStore::getAllConfigurations() { //TODO maybe change to iterator?
     auto result = std::make_shared<std::vector<std::shared_ptr<AbstractConfiguration>>>();
 
     for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
@@ -175,45 +162,24 @@ std::shared_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> getAllConfi
     return result;
 }
 
-} //end namespace Ocpp16
-
-bool configuration_inited = false;
-
-bool configuration_init(FilesystemOpt fsOpt) {
-    if (configuration_inited)
-        return true; //configuration_init() already called; tolerate multiple calls so user can use this store for
+bool ConfigurationStore::init(FilesystemOpt fsOpt) {
+    if (inited)
+        return true; //init() already called; tolerate multiple calls so user can use this store for
                      //credentials outside ArduinoOcpp which need to be loaded before OCPP_initialize()
     bool loadRoutineSuccessful = true;
 #ifndef AO_DEACTIVATE_FLASH
 
-    configurationFilesystemOpt = fsOpt;
+    filesystemOpt = fsOpt;
 
-    if (fsOpt.mustMount()) { 
-#if defined(ESP32)
-        if(!LITTLEFS.begin(fsOpt.formatOnFail())) {
-            AO_DBG_ERR("Error while mounting LITTLEFS");
+    if (fsOpt.mustMount()) {
+        auto filesystem = getFilesystemAdapter();
+        if (!filesystem || !filesystem->begin(fsOpt)) {
+            AO_DBG_ERR("Unable to initialize: unable to mount filesystem");
             loadRoutineSuccessful = false;
         }
-#else
-        //ESP8266
-        SPIFFSConfig cfg;
-        cfg.setAutoFormat(fsOpt.formatOnFail());
-        SPIFFS.setConfig(cfg);
-
-        if (!SPIFFS.begin()) {
-            AO_DBG_ERR("Unable to initialize: unable to mount SPIFFS");
-            loadRoutineSuccessful = false;
-        }
-#endif
     } //end fs mount
 
-    std::shared_ptr<ConfigurationContainer> containerDefault = nullptr;
-    for (auto container = configurationContainers.begin(); container != configurationContainers.end(); container++) {
-        if (!strcmp((*container)->getFilename(), CONFIGURATION_FN)) {
-            containerDefault = (*container);
-            break;
-        }
-    }
+    std::shared_ptr<ConfigurationContainer> containerDefault = getContainer(CONFIGURATION_FN);
 
     if (containerDefault) {
         AO_DBG_DEBUG("Found default container before calling configuration_init(). If you added\n" \
@@ -230,11 +196,11 @@ bool configuration_init(FilesystemOpt fsOpt) {
 
 
 #endif //ndef AO_DEACTIVATE_FLASH
-    configuration_inited = loadRoutineSuccessful;
+    inited = loadRoutineSuccessful;
     return loadRoutineSuccessful;
 }
 
-bool configuration_save() {
+bool ConfigurationStore::save() {
     bool success = true;
 #ifndef AO_DEACTIVATE_FLASH
 
@@ -249,10 +215,56 @@ bool configuration_save() {
     return success;
 }
 
+std::shared_ptr<ConfigurationStore> getDefaultConfigurationStore() {
+    static std::shared_ptr<ConfigurationStore> defaultStore = std::make_shared<ConfigurationStore>();
+    return defaultStore;
+}
+
+template<class T>
+std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged) {
+    return getDefaultConfigurationStore()->declareConfiguration<T>(key, defaultValue, filename, remotePeerCanWrite, remotePeerCanRead, localClientCanWrite, rebootRequiredWhenChanged);
+}
+
+void addConfigurationContainer(std::shared_ptr<ConfigurationContainer> container) {
+    getDefaultConfigurationStore()->addConfigurationContainer(container);
+}
+
+std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersBegin() {
+    return getDefaultConfigurationStore()->getConfigurationContainersBegin();
+}
+
+std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersEnd() {
+    return getDefaultConfigurationStore()->getConfigurationContainersEnd();
+}
+
+namespace Ocpp16 {
+
+std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key) {
+    return getDefaultConfigurationStore()->getConfiguration(key);
+}
+
+std::shared_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> getAllConfigurations() {
+    return getDefaultConfigurationStore()->getAllConfigurations();
+}
+
+} //end namespace Ocpp16
+
+bool configuration_init(FilesystemOpt fsOpt) {
+    return getDefaultConfigurationStore()->init(fsOpt);
+}
+
+bool configuration_save() {
+    return getDefaultConfigurationStore()->save();
+}
+
 template std::shared_ptr<Configuration<int>> createConfiguration(const char *key, int value);
 template std::shared_ptr<Configuration<float>> createConfiguration(const char *key, float value);
 template std::shared_ptr<Configuration<const char *>> createConfiguration(const char *key, const char * value);
 
+template std::shared_ptr<Configuration<int>> ConfigurationStore::declareConfiguration(const char *key, int defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
+template std::shared_ptr<Configuration<float>> ConfigurationStore::declareConfiguration(const char *key, float defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
+template std::shared_ptr<Configuration<const char *>> ConfigurationStore::declareConfiguration(const char *key, const char *defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
+
 template std::shared_ptr<Configuration<int>> declareConfiguration(const char *key, int defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
 template std::shared_ptr<Configuration<float>> declareConfiguration(const char *key, float defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
 template std::shared_ptr<Configuration<const char *>> declareConfiguration(const char *key, const char *defaultValue, const char *filename, bool remotePeerCanWrite, bool remotePeerCanRead, bool localClientCanWrite, bool rebootRequiredWhenChanged);
@@ -10,6 +10,7 @@
 #include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #define CONFIGURATION_FN "/arduino-ocpp.cnf"
@@ -17,6 +18,43 @@
 
 namespace ArduinoOcpp {
 
+/*
+ * Set of configuration containers which belongs to one charge point. Each OcppEngine works on its own store, so that
+ * one process can run several charge points. With a path prefix, the containers of different stores are persisted
+ * into separate files (e.g. prefix "/cp2" gives "/cp2/arduino-ocpp.cnf").
+ */
+class ConfigurationStore {
+private:
+    std::vector<std::shared_ptr<ConfigurationContainer>> configurationContainers;
+    FilesystemOpt filesystemOpt = FilesystemOpt::Use_Mount_FormatOnFail;
+    std::string pathPrefix;
+    bool inited = false;
+
+    std::shared_ptr<ConfigurationContainer> createConfigurationContainer(const char *filename);
+    std::shared_ptr<ConfigurationContainer> getContainer(const char *filename);
+public:
+    ConfigurationStore(const char *pathPrefix = "");
+
+    template <class T>
+    std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename = CONFIGURATION_FN, bool remotePeerCanWrite = true, bool remotePeerCanRead = true, bool localClientCanWrite = true, bool rebootRequiredWhenChanged = false);
+
+    void addConfigurationContainer(std::shared_ptr<ConfigurationContainer> container);
+    std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersBegin() {return configurationContainers.begin();}
+    std::vector<std::shared_ptr<ConfigurationContainer>>::iterator getConfigurationContainersEnd() {return configurationContainers.end();}
+
+    std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key);
+    std::shared_ptr<std::vector<std::shared_ptr<AbstractConfiguration>>> getAllConfigurations();
+
+    bool init(FilesystemOpt fsOpt = FilesystemOpt::Use_Mount_FormatOnFail);
+    bool save();
+};
+
+/*
+ * The store of the Arduino facade (see ArduinoOcpp.h). The free functions below operate on it, so that sketches can
+ * declare their own configurations before OCPP_initialize()
+ */
+std::shared_ptr<ConfigurationStore> getDefaultConfigurationStore();
+
 template <class T>
 std::shared_ptr<Configuration<T>> declareConfiguration(const char *key, T defaultValue, const char *filename = CONFIGURATION_FN, bool remotePeerCanWrite = true, bool remotePeerCanRead = true, bool localClientCanWrite = true, bool rebootRequiredWhenChanged = false);
 
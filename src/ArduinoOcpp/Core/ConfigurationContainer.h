@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <memory>
+#include <string>
 
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
 
@@ -15,7 +16,7 @@ namespace ArduinoOcpp {
 class ConfigurationContainer {
 private:
     std::vector<uint16_t> configurations_revision;
-    const char *filename;
+    std::string filename;
 
 protected:
     std::vector<std::shared_ptr<AbstractConfiguration>> configurations;
@@ -31,7 +32,7 @@ public:
 
     virtual bool save() = 0;
 
-    const char *getFilename() {return filename;};
+    const char *getFilename() {return filename.c_str();};
 
     std::shared_ptr<AbstractConfiguration> getConfiguration(const char *key);
     std::vector<std::shared_ptr<AbstractConfiguration>>::iterator configurationsIteratorBegin() {return configurations.begin();}
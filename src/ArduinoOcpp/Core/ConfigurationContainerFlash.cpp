@@ -3,24 +3,15 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/ConfigurationContainerFlash.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/Debug.h>
 
-#if defined(ESP32)
-#define USE_FS LITTLEFS
-#else
-#define USE_FS SPIFFS
-#endif
-
-#if USE_FS == LITTLEFS
-#include <LITTLEFS.h>
-#elif USE_FS == SPIFFS
-#include <FS.h>
-#else
-#error "FS not supported"
-#endif
+#include <stdlib.h>
+#include <string.h>
 
 #define MAX_FILE_SIZE 4000
 #define MAX_CONFIGURATIONS 50
+#define MAX_TOKEN_SIZE 64
 
 namespace ArduinoOcpp {
 
@@ -32,67 +23,66 @@ bool ConfigurationContainerFlash::load() {
                     "All previously declared values won't be written back");
     }
 
-    if (!USE_FS.exists(getFilename())) {
+    auto filesystem = getFilesystemAdapter();
+    if (!filesystem) {
+        AO_DBG_ERR("Unable to initialize: no filesystem");
+        return false;
+    }
+
+    if (!filesystem->exists(getFilename())) {
         AO_DBG_DEBUG("Populate FS: create configuration file");
         return true;
     }
 
-    File file = USE_FS.open(getFilename(), "r");
+    auto file = filesystem->open(getFilename(), "r");
 
     if (!file) {
         AO_DBG_ERR("Unable to initialize: could not open configuration file %s", getFilename());
         return false;
     }
 
-    if (!file.available()) {
+    size_t file_size = file->size();
+
+    if (file_size == 0) {
         AO_DBG_DEBUG("Populate FS: create configuration file");
-        file.close();
         return true;
     }
 
-    int file_size = file.size();
-
     if (file_size < 2) {
         AO_DBG_ERR("Unable to initialize: too short for json");
-        file.close();
         return false;
     } else if (file_size > MAX_FILE_SIZE) {
         AO_DBG_ERR("Unable to initialize: filesize is too long");
-        file.close();
         return false;
     }
 
-    String token = file.readStringUntil('\n');
-    if (!token.equals("content-type:arduino-ocpp_configuration_file")) {
+    char token [MAX_TOKEN_SIZE];
+    if (!file->readToken('\n', token, sizeof(token)) || strcmp(token, "content-type:arduino-ocpp_configuration_file")) {
         AO_DBG_ERR("Unable to initialize: unrecognized configuration file format");
-        file.close();
         return false;
     }
 
-    token = file.readStringUntil('\n');
-    if (!token.equals("version:1.0")) {
+    if (!file->readToken('\n', token, sizeof(token)) || strcmp(token, "version:1.0")) {
         AO_DBG_ERR("Unable to initialize: unsupported version");
-        file.close();
         return false;
     }
 
-    token = file.readStringUntil(':');
-    if (!token.equals("configurations_len")) {
+    if (!file->readToken(':', token, sizeof(token)) || strcmp(token, "configurations_len")) {
         AO_DBG_ERR("Unable to initialize: missing length statement");
-        file.close();
         return false;
     }
 
-    token = file.readStringUntil('\n');
-    int configurations_len = token.toInt();
+    if (!file->readToken('\n', token, sizeof(token))) {
+        AO_DBG_ERR("Unable to initialize: invalid length statement");
+        return false;
+    }
+    int configurations_len = atoi(token);
     if (configurations_len <= 0) {
         AO_DBG_ERR("Unable to initialize: empty configuration");
-        file.close();
         return true;
     }
     if (configurations_len > MAX_CONFIGURATIONS) {
         AO_DBG_ERR("Unable to initialize: configurations_len is too big");
-        file.close();
         return false;
     }
 
@@ -102,10 +92,9 @@ bool ConfigurationContainerFlash::load() {
 
     DynamicJsonDocument configDoc(jsonCapacity);
 
-    DeserializationError error = deserializeJson(configDoc, file);
+    DeserializationError error = deserializeJson(configDoc, *file);
     if (error) {
         AO_DBG_ERR("Unable to initialize: config file deserialization failed: %s", error.c_str());
-        file.close();
         return false;
     }
 
@@ -130,7 +119,7 @@ bool ConfigurationContainerFlash::load() {
         }
     }
 
-    file.close();
+    file.reset(); //close
 
     configurationsUpdated();
 
@@ -146,11 +135,17 @@ bool ConfigurationContainerFlash::save() {
         return true; //nothing to be done
     }
 
-    if (USE_FS.exists(getFilename())) {
-        USE_FS.remove(getFilename());
+    auto filesystem = getFilesystemAdapter();
+    if (!filesystem) {
+        AO_DBG_ERR("Unable to save: no filesystem");
+        return false;
+    }
+
+    if (filesystem->exists(getFilename())) {
+        filesystem->remove(getFilename());
     }
 
-    File file = USE_FS.open(getFilename(), "w");
+    auto file = filesystem->open(getFilename(), "w");
 
     if (!file) {
         AO_DBG_ERR("Unable to save: could not open configuration file %s", getFilename());
@@ -161,11 +156,14 @@ bool ConfigurationContainerFlash::save() {
 
     size_t numEntries = configurations.size();
 
-    file.print("content-type:arduino-ocpp_configuration_file\n");
-    file.print("version:1.0\n");
-    file.print("configurations_len:");
-    file.print(numEntries, DEC);
-    file.print("\n");
+    char numEntries_str [16];
+    snprintf(numEntries_str, sizeof(numEntries_str), "%zu", numEntries);
+
+    file->print("content-type:arduino-ocpp_configuration_file\n");
+    file->print("version:1.0\n");
+    file->print("configurations_len:");
+    file->print(numEntries_str);
+    file->print("\n");
 
     std::vector<std::shared_ptr<DynamicJsonDocument>> entries;
 
@@ -189,14 +187,13 @@ bool ConfigurationContainerFlash::save() {
     }
 
     // Serialize JSON to file
-    if (serializeJson(configDoc, file) == 0) {
+    if (serializeJson(configDoc, *file) == 0) {
         AO_DBG_ERR("Unable to save: Could not serialize JSON");
-        file.close();
         return false;
     }
 
     //success
-    file.close();
+    file.reset(); //close
     AO_DBG_DEBUG("Saving configDoc successful");
 
 #endif //ndef AO_DEACTIVATE_FLASH
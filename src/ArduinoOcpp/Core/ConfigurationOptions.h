@@ -5,6 +5,8 @@
 #ifndef CONFIGURATIONOPTIONS_H
 #define CONFIGURATIONOPTIONS_H
 
+#include <stdint.h>
+
 namespace ArduinoOcpp {
 
 class FilesystemOpt{
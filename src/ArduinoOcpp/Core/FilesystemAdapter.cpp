@@ -0,0 +1,235 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
+#include <ArduinoOcpp/Platform.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <string.h>
+
+#ifndef AO_DEACTIVATE_FLASH
+#if defined(AO_PLATFORM_ARDUINO)
+
+#if defined(ESP32)
+#include <LITTLEFS.h>
+#define USE_FS LITTLEFS
+#else
+#include <FS.h>
+#define USE_FS SPIFFS
+#endif
+
+#elif defined(AO_PLATFORM_POSIX)
+
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <string>
+
+#endif
+#endif //ndef AO_DEACTIVATE_FLASH
+
+namespace ArduinoOcpp {
+
+size_t FileAdapter::print(const char *str) {
+    return write((const uint8_t*) str, strlen(str));
+}
+
+bool FileAdapter::readToken(char delim, char *buf, size_t size) {
+    if (size == 0) {
+        return false;
+    }
+
+    size_t len = 0;
+    int c;
+    while ((c = read()) >= 0 && c != delim) {
+        if (len + 1 >= size) {
+            buf[len] = '\0';
+            return false;
+        }
+        buf[len++] = (char) c;
+    }
+
+    buf[len] = '\0';
+    return true;
+}
+
+#ifndef AO_DEACTIVATE_FLASH
+#if defined(AO_PLATFORM_ARDUINO)
+
+namespace {
+
+class ArduinoFileAdapter : public FileAdapter {
+private:
+    File file;
+public:
+    ArduinoFileAdapter(File file) : file(file) { }
+    ~ArduinoFileAdapter() {file.close();}
+
+    size_t size() {return file.size();}
+    bool seek(size_t offset) {return file.seek(offset, SeekSet);}
+
+    int read() {return file.read();}
+    size_t readBytes(char *buf, size_t len) {return file.readBytes(buf, len);}
+
+    size_t write(uint8_t c) {return file.write(c);}
+    size_t write(const uint8_t *buf, size_t len) {return file.write(buf, len);}
+};
+
+class ArduinoFilesystemAdapter : public FilesystemAdapter {
+public:
+    bool begin(FilesystemOpt fsOpt) {
+        if (!fsOpt.mustMount()) {
+            return true;
+        }
+#if defined(ESP32)
+        if(!LITTLEFS.begin(fsOpt.formatOnFail())) {
+            AO_DBG_ERR("Error while mounting LITTLEFS");
+            return false;
+        }
+#else
+        //ESP8266
+        SPIFFSConfig cfg;
+        cfg.setAutoFormat(fsOpt.formatOnFail());
+        SPIFFS.setConfig(cfg);
+
+        if (!SPIFFS.begin()) {
+            AO_DBG_ERR("Unable to initialize: unable to mount SPIFFS");
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    bool exists(const char *path) {return USE_FS.exists(path);}
+    bool remove(const char *path) {return USE_FS.remove(path);}
+
+    std::unique_ptr<FileAdapter> open(const char *path, const char *mode) {
+        File file = USE_FS.open(path, mode);
+        if (!file) {
+            return nullptr;
+        }
+        return std::unique_ptr<FileAdapter>(new ArduinoFileAdapter(file));
+    }
+};
+
+} //end anonymous namespace
+
+#define AO_PLATFORM_FILESYSTEM ArduinoFilesystemAdapter
+
+#elif defined(AO_PLATFORM_POSIX)
+
+namespace {
+
+class PosixFileAdapter : public FileAdapter {
+private:
+    FILE *file;
+public:
+    PosixFileAdapter(FILE *file) : file(file) { }
+    ~PosixFileAdapter() {fclose(file);}
+
+    size_t size() {
+        struct stat st;
+        if (fstat(fileno(file), &st)) {
+            return 0;
+        }
+        return (size_t) st.st_size;
+    }
+    bool seek(size_t offset) {return !fseek(file, (long) offset, SEEK_SET);}
+
+    int read() {
+        int c = fgetc(file);
+        return c == EOF ? -1 : c;
+    }
+    size_t readBytes(char *buf, size_t len) {return fread(buf, 1, len, file);}
+
+    size_t write(uint8_t c) {return fputc(c, file) == EOF ? 0 : 1;}
+    size_t write(const uint8_t *buf, size_t len) {return fwrite(buf, 1, len, file);}
+};
+
+class PosixFilesystemAdapter : public FilesystemAdapter {
+private:
+    const std::string root = AO_FILESYSTEM_ROOT;
+
+    std::string fullPath(const char *path) {
+        std::string res = root;
+        if (path[0] != '/') {
+            res += '/';
+        }
+        res += path;
+        return res;
+    }
+
+    //creates all directories of path up to the last '/' (which separates the file name)
+    bool makeParentDirs(const std::string& path) {
+        for (size_t sep = path.find('/', 1); sep != std::string::npos; sep = path.find('/', sep + 1)) {
+            std::string dir = path.substr(0, sep);
+            if (mkdir(dir.c_str(), 0755) && errno != EEXIST) {
+                AO_DBG_ERR("Cannot create directory %s", dir.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+public:
+    bool begin(FilesystemOpt fsOpt) {
+        if (!fsOpt.mustMount()) {
+            return true;
+        }
+        //"mounting" means to make sure the root directory exists
+        return makeParentDirs(root + "/");
+    }
+
+    bool exists(const char *path) {
+        struct stat st;
+        return !stat(fullPath(path).c_str(), &st);
+    }
+
+    bool remove(const char *path) {
+        return !::remove(fullPath(path).c_str());
+    }
+
+    std::unique_ptr<FileAdapter> open(const char *path, const char *mode) {
+        std::string fn = fullPath(path);
+        bool writeMode = strchr(mode, 'w') != nullptr;
+        if (writeMode && !makeParentDirs(fn)) {
+            return nullptr;
+        }
+        FILE *file = fopen(fn.c_str(), writeMode ? "wb" : "rb");
+        if (!file) {
+            return nullptr;
+        }
+        return std::unique_ptr<FileAdapter>(new PosixFileAdapter(file));
+    }
+};
+
+} //end anonymous namespace
+
+#define AO_PLATFORM_FILESYSTEM PosixFilesystemAdapter
+
+#endif
+#endif //ndef AO_DEACTIVATE_FLASH
+
+namespace {
+
+std::shared_ptr<FilesystemAdapter>& filesystemAdapter() {
+#ifdef AO_PLATFORM_FILESYSTEM
+    static std::shared_ptr<FilesystemAdapter> filesystem = std::make_shared<AO_PLATFORM_FILESYSTEM>();
+#else
+    static std::shared_ptr<FilesystemAdapter> filesystem = nullptr;
+#endif
+    return filesystem;
+}
+
+} //end anonymous namespace
+
+std::shared_ptr<FilesystemAdapter> getFilesystemAdapter() {
+    return filesystemAdapter();
+}
+
+void setFilesystemAdapter(std::shared_ptr<FilesystemAdapter> filesystem) {
+    filesystemAdapter() = filesystem;
+}
+
+} //end namespace ArduinoOcpp
@@ -0,0 +1,77 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef FILESYSTEMADAPTER_H
+#define FILESYSTEMADAPTER_H
+
+#include <ArduinoOcpp/Core/ConfigurationOptions.h>
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef AO_FILESYSTEM_ROOT
+#define AO_FILESYSTEM_ROOT "./ao-data" //POSIX only: directory which the paths of the engine are relative to
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Open file of the FilesystemAdapter. The file is closed when the object is destroyed.
+ * 
+ * The read and write functions follow the stream protocol of ArduinoJson, so a FileAdapter can be passed directly
+ * to deserializeJson() and serializeJson()
+ */
+class FileAdapter {
+public:
+    virtual ~FileAdapter() = default;
+
+    virtual size_t size() = 0;
+    virtual bool seek(size_t offset) = 0; //absolute position from the beginning
+
+    virtual int read() = 0; //returns the next byte or -1 at the end of the file
+    virtual size_t readBytes(char *buf, size_t len) = 0;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buf, size_t len) = 0;
+
+    size_t print(const char *str); //writes str without the terminating zero
+
+    /*
+     * Reads until delim or the end of the file and copies the result into buf as zero-terminated string. delim
+     * is consumed but not copied. Returns false if the token doesn't fit into buf
+     */
+    bool readToken(char delim, char *buf, size_t size);
+};
+
+/*
+ * All file I/O of the engine goes through this interface. The Arduino implementation wraps SPIFFS (ESP8266) or
+ * LITTLEFS (ESP32), the POSIX implementation maps the paths into the directory AO_FILESYSTEM_ROOT
+ */
+class FilesystemAdapter {
+public:
+    virtual ~FilesystemAdapter() = default;
+
+    virtual bool begin(FilesystemOpt fsOpt) = 0; //mount according to fsOpt. Returns true on success
+
+    virtual bool exists(const char *path) = 0;
+    virtual bool remove(const char *path) = 0;
+
+    /*
+     * mode "r" opens an existing file for reading, "w" creates or truncates a file for writing. Returns nullptr
+     * on failure
+     */
+    virtual std::unique_ptr<FileAdapter> open(const char *path, const char *mode) = 0;
+};
+
+/*
+ * Filesystem of the platform; nullptr with AO_DEACTIVATE_FLASH. Can be replaced before OCPP_initialize(), e.g.
+ * to run the engine on another filesystem
+ */
+std::shared_ptr<FilesystemAdapter> getFilesystemAdapter();
+void setFilesystemAdapter(std::shared_ptr<FilesystemAdapter> filesystem);
+
+} //end namespace ArduinoOcpp
+
+#endif
@@ -0,0 +1,67 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/FragmentBuffer.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <string.h>
+
+using namespace ArduinoOcpp;
+
+void FragmentBuffer::begin(const uint8_t *payload, size_t length, bool binary) {
+    if (active) {
+        AO_DBG_WARN("Fragmented message not finished. Discard");
+    }
+
+    if (!buf) {
+        buf = std::unique_ptr<char[]>(new char[AO_WS_FRAGMENT_MAXSIZE + 1]); //+1 for the terminating zero
+    }
+
+    len = 0;
+    buf[0] = '\0';
+    active = true;
+    overflow = false;
+    this->binary = binary;
+
+    append(payload, length);
+}
+
+void FragmentBuffer::add(const uint8_t *payload, size_t length) {
+    if (!active) {
+        AO_DBG_WARN("Continuation fragment without start. Discard");
+        return;
+    }
+    append(payload, length);
+}
+
+bool FragmentBuffer::finish(const uint8_t *payload, size_t length) {
+    if (!active) {
+        AO_DBG_WARN("Final fragment without start. Discard");
+        return false;
+    }
+    append(payload, length);
+    active = false;
+
+    if (overflow) {
+        AO_DBG_WARN("Fragmented message exceeds AO_WS_FRAGMENT_MAXSIZE (%u). Discard", (unsigned int) AO_WS_FRAGMENT_MAXSIZE);
+        len = 0;
+        buf[0] = '\0';
+        return false;
+    }
+
+    return true;
+}
+
+void FragmentBuffer::append(const uint8_t *payload, size_t length) {
+    if (overflow) {
+        return;
+    }
+    if (length > AO_WS_FRAGMENT_MAXSIZE - len) {
+        overflow = true;
+        return;
+    }
+    memcpy(buf.get() + len, payload, length);
+    len += length;
+    buf[len] = '\0';
+}
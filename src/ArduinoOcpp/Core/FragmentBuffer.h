@@ -0,0 +1,51 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef FRAGMENTBUFFER_H
+#define FRAGMENTBUFFER_H
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef AO_WS_FRAGMENT_MAXSIZE
+#define AO_WS_FRAGMENT_MAXSIZE 8192 //max size of a WebSocket message which arrives in fragments. Longer messages are dropped
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Reassembles a fragmented WebSocket message. The fragments are copied into one buffer of AO_WS_FRAGMENT_MAXSIZE
+ * bytes, which is allocated when the first fragmented message arrives and then reused. The complete message is
+ * passed to the engine from there, so it is never held in memory twice.
+ * 
+ * Messages which exceed the buffer are discarded as a whole; the following fragments are skipped until the last one
+ */
+class FragmentBuffer {
+private:
+    std::unique_ptr<char[]> buf;
+    size_t len = 0;
+    bool active = false; //inside a fragmented message
+    bool overflow = false; //the current message exceeds the buffer and is discarded
+    bool binary = false;
+
+    void append(const uint8_t *payload, size_t length);
+public:
+    void begin(const uint8_t *payload, size_t length, bool binary); //first fragment
+    void add(const uint8_t *payload, size_t length); //continuation fragment
+
+    /*
+     * Last fragment. Returns true if the message is complete and fits into the buffer. Then data() and size()
+     * refer to the message until the next call of begin()
+     */
+    bool finish(const uint8_t *payload, size_t length);
+
+    const char *data() const {return buf.get();} //zero-terminated
+    size_t size() const {return len;}
+    bool isBinary() const {return binary;}
+};
+
+} //end namespace ArduinoOcpp
+
+#endif
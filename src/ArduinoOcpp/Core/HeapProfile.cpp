@@ -0,0 +1,141 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifdef AO_HEAP_PROFILE
+
+#include <ArduinoOcpp/Core/HeapProfile.h>
+#include <ArduinoOcpp/Platform.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <vector>
+
+using namespace ArduinoOcpp;
+using namespace ArduinoOcpp::HeapProfile;
+
+namespace ArduinoOcpp {
+namespace HeapProfile {
+
+struct OperationEntry {
+    OcppAction opType;
+    Counter stages [(size_t) Stage::StageCount];
+};
+
+static std::vector<OperationEntry> entries;
+static uint32_t minFreeHeap = UINT32_MAX;
+
+static OperationEntry *findEntry(OcppAction opType) {
+    for (auto& entry : entries) {
+        if (entry.opType == opType) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+} //end namespace HeapProfile
+} //end namespace ArduinoOcpp
+
+const char *HeapProfile::getStageName(Stage stage) {
+    switch (stage) {
+        case Stage::CreateReq:
+            return "createReq";
+        case Stage::SendReq:
+            return "sendReq";
+        case Stage::ReceiveConf:
+            return "receiveConf";
+        case Stage::ReceiveReq:
+            return "receiveReq";
+        case Stage::CreateConf:
+            return "createConf";
+        case Stage::SendConf:
+            return "sendConf";
+        default:
+            return "unknown";
+    }
+}
+
+void HeapProfile::record(OcppAction opType, Stage stage, size_t bytes) {
+    if (stage >= Stage::StageCount) {
+        return;
+    }
+
+    uint32_t freeHeap = (uint32_t) ao_avail_heap();
+
+    auto entry = findEntry(opType);
+    if (!entry) {
+        OperationEntry newEntry;
+        newEntry.opType = opType;
+        entries.push_back(newEntry);
+        entry = &entries.back();
+    }
+
+    Counter& counter = entry->stages[(size_t) stage];
+    counter.allocations++;
+    counter.bytes += bytes;
+    if (bytes > counter.maxAllocation) {
+        counter.maxAllocation = bytes;
+    }
+    if (freeHeap < counter.minFreeHeap) {
+        counter.minFreeHeap = freeHeap;
+    }
+    if (freeHeap < minFreeHeap) {
+        minFreeHeap = freeHeap;
+    }
+}
+
+const Counter *HeapProfile::getCounter(const char *opType, Stage stage) {
+    OcppAction action = getOcppAction(opType);
+    if (action == OcppAction::Unknown) {
+        return nullptr;
+    }
+    return getCounter(action, stage);
+}
+
+const Counter *HeapProfile::getCounter(OcppAction opType, Stage stage) {
+    if (stage >= Stage::StageCount) {
+        return nullptr;
+    }
+    auto entry = findEntry(opType);
+    if (!entry || entry->stages[(size_t) stage].allocations == 0) {
+        return nullptr;
+    }
+    return &entry->stages[(size_t) stage];
+}
+
+void HeapProfile::forEach(std::function<void(const char *opType, Stage stage, const Counter& counter)> fn) {
+    if (!fn) {
+        return;
+    }
+    for (auto& entry : entries) {
+        for (size_t i = 0; i < (size_t) Stage::StageCount; i++) {
+            if (entry.stages[i].allocations > 0) {
+                fn(getOcppActionName(entry.opType), (Stage) i, entry.stages[i]);
+            }
+        }
+    }
+}
+
+uint32_t HeapProfile::getMinFreeHeap() {
+    return minFreeHeap;
+}
+
+void HeapProfile::dump() {
+    AO_CONSOLE_PRINTF("[AO] Heap profile (min free heap: %u)\n", (unsigned int) minFreeHeap);
+    AO_CONSOLE_PRINTF("[AO] %-30s %-12s %8s %10s %8s %10s\n", "operation", "stage", "allocs", "bytes", "max", "min free");
+    forEach([] (const char *opType, Stage stage, const Counter& counter) {
+        AO_CONSOLE_PRINTF("[AO] %-30s %-12s %8lu %10u %8u %10u\n",
+                opType, getStageName(stage),
+                counter.allocations,
+                (unsigned int) counter.bytes,
+                (unsigned int) counter.maxAllocation,
+                (unsigned int) counter.minFreeHeap);
+    });
+}
+
+void HeapProfile::reset() {
+    entries.clear();
+    minFreeHeap = UINT32_MAX;
+}
+
+#endif //def AO_HEAP_PROFILE
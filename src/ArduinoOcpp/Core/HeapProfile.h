@@ -0,0 +1,73 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+/**
+ * Heap instrumentation of the OCPP engine. With the build flag AO_HEAP_PROFILE, the engine records every JSON
+ * document and serialized frame which it creates for an operation, attributed to the operation type (e.g.
+ * "MeterValues") and the engine stage (e.g. createReq). For each pair it counts the allocations, the bytes and
+ * the largest allocation, and it samples the free heap to find the low-water mark (= heap high-water) per stage.
+ * 
+ * Without AO_HEAP_PROFILE, the recording macro expands to nothing and this module isn't compiled in.
+ */
+
+#ifndef AO_HEAPPROFILE_H
+#define AO_HEAPPROFILE_H
+
+#ifdef AO_HEAP_PROFILE
+
+#include <ArduinoOcpp/Core/OcppAction.h>
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ArduinoOcpp {
+namespace HeapProfile {
+
+enum class Stage : uint8_t {
+    CreateReq,      //payload document of an outgoing request (OcppMessage::createReq)
+    SendReq,        //serialized request frame
+    ReceiveConf,    //parsed incoming CALLRESULT / CALLERROR
+    ReceiveReq,     //parsed incoming CALL
+    CreateConf,     //payload document of an outgoing conf (OcppMessage::createConf) or CallError details
+    SendConf,       //serialized conf frame
+    StageCount
+};
+
+const char *getStageName(Stage stage);
+
+struct Counter {
+    unsigned long allocations = 0;
+    size_t bytes = 0; //sum over all allocations
+    size_t maxAllocation = 0; //largest single allocation
+    uint32_t minFreeHeap = UINT32_MAX; //lowest free heap observed while a document of this stage was alive
+};
+
+/*
+ * Records an allocation of the given size, attributed to the operation type, e.g. OcppOperation::getOcppAction()
+ */
+void record(OcppAction opType, Stage stage, size_t bytes);
+
+const Counter *getCounter(OcppAction opType, Stage stage); //nullptr if there was no allocation yet
+const Counter *getCounter(const char *opType, Stage stage);
+
+void forEach(std::function<void(const char *opType, Stage stage, const Counter& counter)> fn);
+
+uint32_t getMinFreeHeap(); //lowest free heap observed by any recording
+
+void dump(); //print all counters on the console
+
+void reset();
+
+} //end namespace HeapProfile
+} //end namespace ArduinoOcpp
+
+#define AO_HEAP_RECORD(opType, stage, bytes) ArduinoOcpp::HeapProfile::record(opType, ArduinoOcpp::HeapProfile::Stage::stage, bytes)
+
+#else
+
+#define AO_HEAP_RECORD(opType, stage, bytes)
+
+#endif //def AO_HEAP_PROFILE
+#endif
@@ -0,0 +1,133 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef INLINECALLBACK_H
+#define INLINECALLBACK_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifndef AO_CALLBACK_CAPACITY
+#define AO_CALLBACK_CAPACITY (4 * sizeof(void*)) //in bytes; max size of a callable stored in an InlineCallback. The default fits a std::function
+#endif
+
+namespace ArduinoOcpp {
+
+template<class Signature>
+class InlineCallback;
+
+/*
+ * Replacement for std::function which never allocates. The callable is stored in a fixed buffer of
+ * AO_CALLBACK_CAPACITY bytes inside the InlineCallback and a callable which doesn't fit is rejected at
+ * compile time. Lambdas which capture a few pointers or references (e.g. [this]) always fit. To keep a
+ * bigger state, capture a pointer to it or wrap the lambda into a std::function.
+ *
+ * Calling an empty InlineCallback does nothing and returns a default-constructed R
+ */
+template<class R, class... Args>
+class InlineCallback<R(Args...)> {
+private:
+    typedef typename std::aligned_storage<AO_CALLBACK_CAPACITY, std::alignment_of<double>::value>::type Storage; //captured pointers, integers and doubles are aligned
+
+    struct Ops {
+        R (*invoke)(const Storage& storage, Args... args);
+        void (*copy)(Storage& dst, const Storage& src);
+        void (*destroy)(Storage& storage);
+    };
+
+    template<class Callable>
+    struct Impl {
+        static R invoke(const Storage& storage, Args... args) {
+            return (*const_cast<Callable*>(reinterpret_cast<const Callable*>(&storage)))(std::forward<Args>(args)...);
+        }
+        static void copy(Storage& dst, const Storage& src) {
+            new (&dst) Callable(*reinterpret_cast<const Callable*>(&src));
+        }
+        static void destroy(Storage& storage) {
+            reinterpret_cast<Callable*>(&storage)->~Callable();
+        }
+        static const Ops ops;
+    };
+
+    Storage storage;
+    const Ops *ops = nullptr; //nullptr if empty
+
+    template<class Callable>
+    static bool isNull(const Callable&) {return false;}
+    template<class P>
+    static bool isNull(P *fn) {return fn == nullptr;}
+    static bool isNull(const std::function<R(Args...)>& fn) {return !fn;}
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    void copyFrom(const InlineCallback& other) {
+        if (other.ops) {
+            other.ops->copy(storage, other.storage);
+            ops = other.ops;
+        }
+    }
+public:
+    InlineCallback() = default;
+
+    InlineCallback(std::nullptr_t) { }
+
+    template<class Callable, class = typename std::enable_if<!std::is_same<typename std::decay<Callable>::type, InlineCallback>::value>::type>
+    InlineCallback(Callable fn) {
+        static_assert(sizeof(Callable) <= sizeof(Storage), "callable exceeds AO_CALLBACK_CAPACITY. Capture less state or increase the build flag");
+        static_assert(std::alignment_of<Callable>::value <= std::alignment_of<Storage>::value, "callable is over-aligned");
+        if (!isNull(fn)) {
+            new (&storage) Callable(std::move(fn));
+            ops = &Impl<Callable>::ops;
+        }
+    }
+
+    InlineCallback(const InlineCallback& other) {
+        copyFrom(other);
+    }
+
+    InlineCallback& operator=(const InlineCallback& other) {
+        if (this != &other) {
+            reset();
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    InlineCallback& operator=(std::nullptr_t) {
+        reset();
+        return *this;
+    }
+
+    ~InlineCallback() {
+        reset();
+    }
+
+    explicit operator bool() const {return ops != nullptr;}
+
+    R operator()(Args... args) const {
+        if (!ops) {
+            return R();
+        }
+        return ops->invoke(storage, std::forward<Args>(args)...);
+    }
+};
+
+template<class R, class... Args>
+template<class Callable>
+const typename InlineCallback<R(Args...)>::Ops InlineCallback<R(Args...)>::Impl<Callable>::ops = {
+    &InlineCallback<R(Args...)>::Impl<Callable>::invoke,
+    &InlineCallback<R(Args...)>::Impl<Callable>::copy,
+    &InlineCallback<R(Args...)>::Impl<Callable>::destroy
+};
+
+} //end namespace ArduinoOcpp
+#endif
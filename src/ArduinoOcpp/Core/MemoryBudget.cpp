@@ -0,0 +1,53 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/MemoryBudget.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Platform.h>
+
+using namespace ArduinoOcpp;
+
+QueueBudget::QueueBudget(ConfigurationStore& configurationStore, const char *maxCountKey, int defaultMaxCount, const char *maxBytesKey, int defaultMaxBytes, BudgetPolicy policy) : policy(policy) {
+    maxCount = configurationStore.declareConfiguration<int>(maxCountKey, defaultMaxCount, CONFIGURATION_FN, true, true, true, false);
+    maxBytes = configurationStore.declareConfiguration<int>(maxBytesKey, defaultMaxBytes, CONFIGURATION_FN, true, true, true, false);
+}
+
+bool QueueBudget::fits(size_t entryBytes) const {
+    if (*maxCount > 0 && count + 1 > (size_t) *maxCount) {
+        return false;
+    }
+
+    if (*maxBytes > 0 && bytes + entryBytes > (size_t) *maxBytes) {
+        return false;
+    }
+
+    //the quotas are only estimates. The heap reserve protects the rest of the firmware in any case
+    if ((size_t) ao_avail_heap() < entryBytes + AO_HEAP_RESERVE) {
+        return false;
+    }
+
+    return true;
+}
+
+void QueueBudget::add(size_t entryBytes) {
+    count++;
+    bytes += entryBytes;
+}
+
+void QueueBudget::remove(size_t entryBytes) {
+    count = count > 0 ? count - 1 : 0;
+    bytes = bytes >= entryBytes ? bytes - entryBytes : 0;
+}
+
+QueueBudgetStatus QueueBudget::getStatus() const {
+    QueueBudgetStatus status;
+    status.count = count;
+    status.bytes = bytes;
+    status.maxCount = *maxCount > 0 ? (size_t) *maxCount : 0;
+    status.maxBytes = *maxBytes > 0 ? (size_t) *maxBytes : 0;
+    status.rejected = rejected;
+    status.dropped = dropped;
+    status.saturated = !fits(0);
+    return status;
+}
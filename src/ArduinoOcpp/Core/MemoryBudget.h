@@ -0,0 +1,72 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <memory>
+#include <stddef.h>
+
+#include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+
+#ifndef AO_HEAP_RESERVE
+#define AO_HEAP_RESERVE 4096 //the queues don't accept new operations if the free heap would fall below this value
+#endif
+
+namespace ArduinoOcpp {
+
+class ConfigurationStore;
+
+enum class BudgetPolicy {
+    Reject,     //refuse new entries while the budget is exhausted
+    DropOldest  //make room by discarding the oldest entries which may be discarded; refuse if there are none
+};
+
+/*
+ * Snapshot of a queue budget for the host application
+ */
+struct QueueBudgetStatus {
+    size_t count = 0; //number of queued operations
+    size_t bytes = 0; //estimated heap usage of the queued operations
+    size_t maxCount = 0;
+    size_t maxBytes = 0;
+    unsigned long rejected = 0; //operations which were refused since startup
+    unsigned long dropped = 0; //operations which were discarded to make room since startup
+    bool saturated = false; //true if the next operation would exceed the budget
+};
+
+/*
+ * Quotas and byte accounting of one operation queue. The quotas are configurations, so that the central system
+ * can adjust them to the available memory of the device. The queue owner calls fits() before adding an entry and
+ * decides by the policy what to do if the entry doesn't fit.
+ */
+class QueueBudget {
+private:
+    std::shared_ptr<Configuration<int>> maxCount;
+    std::shared_ptr<Configuration<int>> maxBytes;
+    const BudgetPolicy policy;
+
+    size_t count = 0;
+    size_t bytes = 0;
+    unsigned long rejected = 0;
+    unsigned long dropped = 0;
+public:
+    QueueBudget(ConfigurationStore& configurationStore, const char *maxCountKey, int defaultMaxCount, const char *maxBytesKey, int defaultMaxBytes, BudgetPolicy policy);
+
+    bool fits(size_t entryBytes) const; //if an entry of this size can be added without exceeding the quotas and the heap reserve
+
+    void add(size_t entryBytes);
+    void remove(size_t entryBytes);
+
+    void reportRejected() {rejected++;}
+    void reportDropped() {dropped++;}
+
+    BudgetPolicy getPolicy() const {return policy;}
+    bool isEmpty() const {return count == 0;}
+
+    QueueBudgetStatus getStatus() const;
+};
+
+} //end namespace ArduinoOcpp
+#endif
@@ -0,0 +1,206 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/ObjectPool.h>
+#include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Platform.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <new>
+#include <stdlib.h>
+
+/*
+ * The pools are shared by all engines of the process. Lock them wherever the engine can run on more than one
+ * thread: with the command queue, with the I/O thread (AO_THREADED_IO) or with several engines on different
+ * threads. Only the ESP8266 runs everything on one thread
+ */
+#if defined(AO_COMMAND_QUEUE) || defined(AO_THREADED_IO) || defined(ESP32) || defined(AO_PLATFORM_POSIX)
+#define AO_POOLS_SHARED
+#include <mutex>
+#endif
+
+#define AO_POOL_ALIGN (2 * sizeof(void*)) //like malloc
+
+using namespace ArduinoOcpp;
+
+ObjectPool::ObjectPool(const char *name, size_t slotSize, size_t capacity) : name(name), capacity(capacity) {
+    this->slotSize = (slotSize + AO_POOL_ALIGN - 1) / AO_POOL_ALIGN * AO_POOL_ALIGN;
+    stats.slotSize = this->slotSize;
+    stats.capacity = capacity;
+}
+
+void *ObjectPool::allocate() {
+    if (!slab && capacity > 0) {
+        slab = (unsigned char*) malloc(slotSize * capacity);
+        if (!slab) {
+            AO_DBG_WARN("Cannot allocate slab of pool %s", name);
+            capacity = 0;
+            stats.capacity = 0;
+            return nullptr;
+        }
+        for (size_t i = capacity; i > 0; i--) {
+            void *slot = slab + (i - 1) * slotSize;
+            *((void**) slot) = freeList;
+            freeList = slot;
+        }
+    }
+
+    if (!freeList) {
+        return nullptr;
+    }
+
+    void *slot = freeList;
+    freeList = *((void**) slot);
+
+    stats.allocations++;
+    stats.inUse++;
+    if (stats.inUse > stats.peak) {
+        stats.peak = stats.inUse;
+    }
+    return slot;
+}
+
+void ObjectPool::release(void *ptr) {
+    *((void**) ptr) = freeList;
+    freeList = ptr;
+    stats.inUse--;
+}
+
+void ObjectPool::resetStats() {
+    stats.peak = stats.inUse;
+    stats.allocations = 0;
+    stats.fallbacks = 0;
+}
+
+namespace ArduinoOcpp {
+namespace Pools {
+
+/*
+ * The pools are never destroyed: objects may still be freed during the static destruction
+ */
+ObjectPool& operationPool() {
+    static ObjectPool *pool = new ObjectPool("operation", sizeof(OcppOperation), AO_POOL_OPERATIONS);
+    return *pool;
+}
+
+ObjectPool *const *sizeClasses() {
+    static ObjectPool *classes [] = {
+        new ObjectPool("small", AO_POOL_SMALL_SIZE, AO_POOL_SMALL),
+        new ObjectPool("medium", AO_POOL_MEDIUM_SIZE, AO_POOL_MEDIUM),
+        new ObjectPool("large", AO_POOL_LARGE_SIZE, AO_POOL_LARGE),
+        nullptr
+    };
+    return classes;
+}
+
+#ifdef AO_POOLS_SHARED
+std::mutex poolMutex;
+#define AO_POOL_LOCK std::lock_guard<std::mutex> lock(poolMutex)
+#else
+#define AO_POOL_LOCK
+#endif
+
+} //end namespace Pools
+} //end namespace ArduinoOcpp
+
+void *Pools::allocateOperation(size_t size) {
+    {
+        AO_POOL_LOCK;
+        auto& pool = operationPool();
+        if (size <= pool.getStats().slotSize) {
+            if (void *ptr = pool.allocate()) {
+                return ptr;
+            }
+            pool.countFallback();
+        }
+    }
+    return ::operator new(size);
+}
+
+void *Pools::allocateObject(size_t size) {
+    {
+        AO_POOL_LOCK;
+        for (auto pool = sizeClasses(); *pool; pool++) {
+            if (size <= (*pool)->getStats().slotSize) {
+                if (void *ptr = (*pool)->allocate()) {
+                    return ptr;
+                }
+                (*pool)->countFallback();
+                break; //don't take the slots of the larger classes
+            }
+        }
+    }
+    return ::operator new(size);
+}
+
+void Pools::release(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+
+    {
+        AO_POOL_LOCK;
+        if (operationPool().owns(ptr)) {
+            operationPool().release(ptr);
+            return;
+        }
+        for (auto pool = sizeClasses(); *pool; pool++) {
+            if ((*pool)->owns(ptr)) {
+                (*pool)->release(ptr);
+                return;
+            }
+        }
+    }
+    ::operator delete(ptr);
+}
+
+void Pools::forEach(std::function<void(const char *name, const PoolStats& stats)> fn) {
+    if (!fn) {
+        return;
+    }
+
+    //copy the statistics under the lock and call fn without it, so that fn may allocate (e.g. print)
+    const size_t MAX_POOLS = 4;
+    const char *names [MAX_POOLS];
+    PoolStats stats [MAX_POOLS];
+    size_t n = 0;
+    {
+        AO_POOL_LOCK;
+        names[n] = operationPool().getName();
+        stats[n] = operationPool().getStats();
+        n++;
+        for (auto pool = sizeClasses(); *pool && n < MAX_POOLS; pool++) {
+            names[n] = (*pool)->getName();
+            stats[n] = (*pool)->getStats();
+            n++;
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        fn(names[i], stats[i]);
+    }
+}
+
+void Pools::dump() {
+    AO_CONSOLE_PRINTF("[AO] Object pools\n");
+    AO_CONSOLE_PRINTF("[AO] %-10s %6s %6s %6s %6s %10s %10s\n", "pool", "slot", "cap", "used", "peak", "allocs", "fallbacks");
+    forEach([] (const char *name, const PoolStats& stats) {
+        AO_CONSOLE_PRINTF("[AO] %-10s %6u %6u %6u %6u %10lu %10lu\n",
+                name,
+                (unsigned int) stats.slotSize,
+                (unsigned int) stats.capacity,
+                (unsigned int) stats.inUse,
+                (unsigned int) stats.peak,
+                stats.allocations,
+                stats.fallbacks);
+    });
+}
+
+void Pools::resetStats() {
+    AO_POOL_LOCK;
+    operationPool().resetStats();
+    for (auto pool = sizeClasses(); *pool; pool++) {
+        (*pool)->resetStats();
+    }
+}
@@ -0,0 +1,106 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+/**
+ * Object pools for the short-lived objects of the engine. Every operation allocates an OcppOperation, an
+ * OcppMessage subclass and a Timeout, and frees them when it completes. On the ESP8266, this churn fragments the
+ * heap during long sessions. These classes overload operator new / delete and take their memory from fixed slabs:
+ * 
+ *     - "operation": OcppOperation objects, capacity AO_POOL_OPERATIONS
+ *     - "small", "medium", "large": size classes for OcppMessage and Timeout objects up to AO_POOL_SMALL_SIZE,
+ *       AO_POOL_MEDIUM_SIZE and AO_POOL_LARGE_SIZE bytes, capacities AO_POOL_SMALL, AO_POOL_MEDIUM, AO_POOL_LARGE
+ * 
+ * Each slab is allocated in one piece on its first use and then kept. If a pool is exhausted, the object is
+ * allocated on the heap as before and counted as fallback. Objects larger than the largest size class always
+ * come from the heap.
+ * 
+ * Set a capacity to 0 to disable a pool, or define AO_DEACTIVATE_POOLS to disable all pools
+ */
+
+#ifndef AO_OBJECTPOOL_H
+#define AO_OBJECTPOOL_H
+
+#include <functional>
+#include <stddef.h>
+
+#ifndef AO_POOL_OPERATIONS
+#define AO_POOL_OPERATIONS 8 //number of OcppOperation slots
+#endif
+
+#ifndef AO_POOL_SMALL_SIZE
+#define AO_POOL_SMALL_SIZE (8 * sizeof(void*)) //in bytes
+#endif
+
+#ifndef AO_POOL_SMALL
+#define AO_POOL_SMALL 8 //number of slots
+#endif
+
+#ifndef AO_POOL_MEDIUM_SIZE
+#define AO_POOL_MEDIUM_SIZE (16 * sizeof(void*))
+#endif
+
+#ifndef AO_POOL_MEDIUM
+#define AO_POOL_MEDIUM 12
+#endif
+
+#ifndef AO_POOL_LARGE_SIZE
+#define AO_POOL_LARGE_SIZE (32 * sizeof(void*))
+#endif
+
+#ifndef AO_POOL_LARGE
+#define AO_POOL_LARGE 4
+#endif
+
+namespace ArduinoOcpp {
+
+struct PoolStats {
+    size_t slotSize = 0;
+    size_t capacity = 0;
+    size_t inUse = 0;
+    size_t peak = 0; //highest inUse so far
+    unsigned long allocations = 0; //served from the slab
+    unsigned long fallbacks = 0; //served from the heap because the pool was exhausted
+};
+
+class ObjectPool {
+private:
+    const char *name;
+    size_t slotSize;
+    size_t capacity;
+    unsigned char *slab = nullptr;
+    void *freeList = nullptr;
+    PoolStats stats;
+public:
+    ObjectPool(const char *name, size_t slotSize, size_t capacity);
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    void *allocate(); //nullptr if exhausted
+    bool owns(void *ptr) const {return slab && ptr >= slab && ptr < slab + slotSize * capacity;}
+    void release(void *ptr); //ptr must be owned by this pool
+
+    void countFallback() {stats.fallbacks++;}
+
+    const char *getName() const {return name;}
+    const PoolStats& getStats() const {return stats;}
+    void resetStats(); //keeps inUse
+};
+
+namespace Pools {
+
+void *allocateOperation(size_t size);
+void *allocateObject(size_t size); //picks the smallest size class which fits
+void release(void *ptr); //frees ptr to its pool or to the heap
+
+void forEach(std::function<void(const char *name, const PoolStats& stats)> fn);
+
+void dump(); //print the statistics on the console
+
+void resetStats();
+
+} //end namespace Pools
+} //end namespace ArduinoOcpp
+
+#endif
@@ -0,0 +1,149 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/OcppAction.h>
+
+#include <string.h>
+#include <vector>
+
+/*
+ * The custom actions are shared by all engines of the process and are read on every incoming frame. Lock them
+ * under the same conditions as the object pools (see ObjectPool.cpp)
+ */
+#if defined(AO_COMMAND_QUEUE) || defined(AO_THREADED_IO) || defined(ESP32) || defined(AO_PLATFORM_POSIX)
+#define AO_ACTIONS_SHARED
+#include <mutex>
+#endif
+
+namespace ArduinoOcpp {
+
+namespace {
+
+//index i holds the name of OcppAction i. Sorted alphabetically, like the enum
+const char * const standardActionNames [] = {
+    "Unknown",
+    "Authorize",
+    "BootNotification",
+    "CancelReservation",
+    "ChangeAvailability",
+    "ChangeConfiguration",
+    "ClearCache",
+    "ClearChargingProfile",
+    "DataTransfer",
+    "DiagnosticsStatusNotification",
+    "FirmwareStatusNotification",
+    "GetCompositeSchedule",
+    "GetConfiguration",
+    "GetDiagnostics",
+    "GetLocalListVersion",
+    "Heartbeat",
+    "MeterValues",
+    "RemoteStartTransaction",
+    "RemoteStopTransaction",
+    "ReserveNow",
+    "Reset",
+    "SendLocalList",
+    "SetChargingProfile",
+    "StartTransaction",
+    "StatusNotification",
+    "StopTransaction",
+    "TriggerMessage",
+    "UnlockConnector",
+    "UpdateFirmware",
+};
+
+static_assert(sizeof(standardActionNames) / sizeof(standardActionNames[0]) == (size_t) OcppAction::StandardCount,
+        "name table must match the OcppAction enum");
+
+std::vector<const char*> customActionNames; //index i holds the name of OcppAction StandardCount + i
+
+#ifdef AO_ACTIONS_SHARED
+std::mutex customActionMutex;
+#define AO_ACTIONS_LOCK std::lock_guard<std::mutex> lock(customActionMutex)
+#else
+#define AO_ACTIONS_LOCK
+#endif
+
+OcppAction findStandardAction(const char *name) {
+    //binary search over the standard actions; index 0 ("Unknown") is excluded
+    size_t lo = 1, hi = (size_t) OcppAction::StandardCount;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(standardActionNames[mid], name);
+        if (cmp == 0) {
+            return (OcppAction) mid;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return OcppAction::Unknown;
+}
+
+//caller holds the lock
+OcppAction findCustomAction(const char *name) {
+    for (size_t i = 0; i < customActionNames.size(); i++) {
+        if (!strcmp(customActionNames[i], name)) {
+            return (OcppAction) ((size_t) OcppAction::StandardCount + i);
+        }
+    }
+
+    return OcppAction::Unknown;
+}
+
+} //end anonymous namespace
+
+OcppAction getOcppAction(const char *name) {
+    if (!name) {
+        return OcppAction::Unknown;
+    }
+
+    OcppAction action = findStandardAction(name); //the standard table is constant; no lock needed
+    if (action != OcppAction::Unknown) {
+        return action;
+    }
+
+    AO_ACTIONS_LOCK;
+    return findCustomAction(name);
+}
+
+OcppAction registerOcppAction(const char *name) {
+    if (!name) {
+        return OcppAction::Unknown;
+    }
+
+    OcppAction action = findStandardAction(name);
+    if (action != OcppAction::Unknown) {
+        return action;
+    }
+
+    AO_ACTIONS_LOCK;
+    action = findCustomAction(name);
+    if (action == OcppAction::Unknown) {
+        action = (OcppAction) ((size_t) OcppAction::StandardCount + customActionNames.size());
+        customActionNames.push_back(name);
+    }
+    return action;
+}
+
+const char *getOcppActionName(OcppAction action) {
+    size_t id = (size_t) action;
+    if (id < (size_t) OcppAction::StandardCount) {
+        return standardActionNames[id];
+    }
+    id -= (size_t) OcppAction::StandardCount;
+    AO_ACTIONS_LOCK;
+    if (id < customActionNames.size()) {
+        return customActionNames[id];
+    }
+    return standardActionNames[0];
+}
+
+size_t getOcppActionCount() {
+    AO_ACTIONS_LOCK;
+    return (size_t) OcppAction::StandardCount + customActionNames.size();
+}
+
+} //end namespace ArduinoOcpp
@@ -0,0 +1,72 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef OCPPACTION_H
+#define OCPPACTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace ArduinoOcpp {
+
+/*
+ * Interned identifier of an OCPP action (the operation type, e.g. "StartTransaction"). The name of an incoming
+ * CALL is looked up once when its header is parsed; from then on, the engine dispatches, records metrics and
+ * compares actions as integers.
+ * 
+ * The standard OCPP 1.6 actions are enumerated in alphabetical order. Custom actions receive IDs from
+ * StandardCount on when they are registered. These IDs are shared by all engines of the process
+ */
+enum class OcppAction : uint16_t {
+    Unknown = 0,
+    Authorize,
+    BootNotification,
+    CancelReservation,
+    ChangeAvailability,
+    ChangeConfiguration,
+    ClearCache,
+    ClearChargingProfile,
+    DataTransfer,
+    DiagnosticsStatusNotification,
+    FirmwareStatusNotification,
+    GetCompositeSchedule,
+    GetConfiguration,
+    GetDiagnostics,
+    GetLocalListVersion,
+    Heartbeat,
+    MeterValues,
+    RemoteStartTransaction,
+    RemoteStopTransaction,
+    ReserveNow,
+    Reset,
+    SendLocalList,
+    SetChargingProfile,
+    StartTransaction,
+    StatusNotification,
+    StopTransaction,
+    TriggerMessage,
+    UnlockConnector,
+    UpdateFirmware,
+    StandardCount //first custom ID
+};
+
+/*
+ * Returns the ID of a standard or registered custom action, or OcppAction::Unknown
+ */
+OcppAction getOcppAction(const char *name);
+
+/*
+ * Returns the ID of name and registers it as custom action if it is unknown. The library keeps the pointer
+ * name, i.e. it must remain valid (e.g. a string literal). Thread-safe; the registry is locked under the same
+ * conditions as the object pools
+ */
+OcppAction registerOcppAction(const char *name);
+
+const char *getOcppActionName(OcppAction action); //"Unknown" for unregistered IDs
+
+size_t getOcppActionCount(); //upper bound of all IDs which have been assigned so far, for tables indexed by ID
+
+} //end namespace ArduinoOcpp
+
+#endif
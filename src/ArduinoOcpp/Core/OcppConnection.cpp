@@ -7,84 +7,312 @@
 #include <ArduinoOcpp/Core/OcppSocket.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/OcppError.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/OcppModel.h>
 
 #include <ArduinoOcpp/Debug.h>
 
-#define HEAP_GUARD 2000UL //will not accept JSON messages if it will result in less than HEAP_GUARD free bytes in heap
+#include <ArduinoOcpp/Platform.h>
 
-size_t removePayload(const char *src, size_t src_size, char *dst, size_t dst_size);
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#define MESSAGE_TYPE_FRAMING_PROBE 0 //not used by OCPP-J. The probe frame is the MessagePack array [0]
 
 using namespace ArduinoOcpp;
 
-OcppConnection::OcppConnection(OcppSocket& ocppSock, std::shared_ptr<OcppModel> baseModel) : baseModel{baseModel} {
+OcppConnection::OcppConnection(OcppSocket& ocppSock, std::shared_ptr<OcppModel> baseModel, OcppOperationFactory& operationFactory)
+        : baseModel{baseModel}, operationFactory(operationFactory),
+          initiatedBudget{baseModel->getConfigurationStore(), "AO_INITIATED_OPS_MAX", AO_INITIATED_OPS_MAX, "AO_INITIATED_OPS_BYTES", AO_INITIATED_OPS_BYTES, AO_INITIATED_OPS_POLICY},
+          receivedBudget{baseModel->getConfigurationStore(), "AO_RECEIVED_OPS_MAX", AO_RECEIVED_OPS_MAX, "AO_RECEIVED_OPS_BYTES", AO_RECEIVED_OPS_BYTES, BudgetPolicy::Reject} {
+    callWindowSize = baseModel->getConfigurationStore().declareConfiguration<int>("AO_CALL_WINDOW", 1, CONFIGURATION_FN, false, false, true, false);
+    framingMode = baseModel->getConfigurationStore().declareConfiguration<int>("AO_FRAMING", (int) AO_FRAMING_MODE, CONFIGURATION_FN, false, false, true, false);
+
+    probePending = getFramingMode() == FramingMode::Prefer;
+
     ReceiveTXTcallback callback = [this] (const char *payload, size_t length) {
         return this->processOcppSocketInputTXT(payload, length);
     };
     
     ocppSock.setReceiveTXTcallback(callback);
+
+    ReceiveBINcallback callbackBIN = [this] (const uint8_t *payload, size_t length) {
+        return this->processOcppSocketInputBIN(payload, length);
+    };
+
+    ocppSock.setReceiveBINcallback(callbackBIN);
+
+    ConnectionStateCallback callbackState = [this] (bool connected) {
+        this->processOcppSocketConnectionState(connected);
+    };
+
+    ocppSock.setConnectionStateCallback(callbackState);
+}
+
+FramingMode OcppConnection::getFramingMode() {
+    int mode = framingMode ? (int) *framingMode : (int) AO_FRAMING_MODE;
+    switch (mode) {
+        case (int) FramingMode::Accept:
+            return FramingMode::Accept;
+        case (int) FramingMode::Prefer:
+            return FramingMode::Prefer;
+        default:
+            return FramingMode::Off;
+    }
+}
+
+bool OcppConnection::sendProbe(OcppSocket& ocppSock) {
+    char *frame = ocppSock.reserveTXT(2);
+    if (!frame) {
+        return false;
+    }
+    frame[0] = (char) 0x91; //fixarray with one element
+    frame[1] = (char) MESSAGE_TYPE_FRAMING_PROBE; //positive fixint
+    AO_DBG_DEBUG("Offer MessagePack framing");
+    return ocppSock.commitBIN(2);
 }
 
 void OcppConnection::loop(OcppSocket& ocppSock) {
 
     /**
-     * Work through the initiatedOcppOperations queue. Start with the first element by calling req() on it. If
-     * the operation is (still) pending, it will return false and therefore each other queued element must
-     * wait until this operation is over. If an ocppOperation is finished, it returns true on a req() call, 
-     * can be dequeued and the following ocppOperation is processed.
+     * Offer MessagePack framing or answer the offer of the other end
      */
-
-    auto operation = initiatedOcppOperations.begin();
-    while (operation != initiatedOcppOperations.end()){
-        boolean timeout = (*operation)->sendReq(ocppSock); //The only reason to dequeue elements here is when a timeout occurs. Normally
-        if (timeout){                                       //the Conf msg processing routine dequeues finished elements
-            operation = initiatedOcppOperations.erase(operation);
-        } else {
-            //there is one operation pending right now, so quit this while-loop.
-            break;
+    if (probePending) {
+        if (getFramingMode() == FramingMode::Off) {
+            probePending = false;
+        } else if (sendProbe(ocppSock)) {
+            probePending = false;
+            probeSent = true;
         }
     }
 
-    /*
-     * Activate timeout detection on the msgs other than the first in the queue.
+    /**
+     * Start the initiated operations for which the call window has room. Only needed after the queue has changed
+     */
+    if (admissionPending) {
+        admitOperations(ocppSock);
+    }
+
+    /**
+     * Process the initiated operations whose retry or timeout deadline has passed. The other operations are not
+     * touched in this loop. Pending operations are resent by calling sendReq(). sendReq() returns true if the
+     * operation has timed out, then it is dequeued. Normally the Conf msg processing routine dequeues finished
+     * elements. Operations which wait for being sent are ticked to activate their timeout detection.
      */
 
-    operation = initiatedOcppOperations.begin();
-    while (operation != initiatedOcppOperations.end()) {
-        if (operation == initiatedOcppOperations.begin()){ //jump over the first element
-            ++operation; 
-            continue; 
-        } 
-        Timeout *timer = (*operation)->getTimeout();
-        if (!timer) {
-            ++operation; //no timeouts, nothing to do in this iteration
-            continue;
+    ulong now = ao_tick_ms();
+
+    while (!schedule.empty() && (long) (schedule.front().due - now) <= 0) {
+        std::pop_heap(schedule.begin(), schedule.end(), ScheduleEntry::later);
+        int msgIdNum = schedule.back().msgIdNum;
+        schedule.pop_back();
+
+        auto entry = initiatedOcppOperationsIndex.find(msgIdNum);
+        if (entry == initiatedOcppOperationsIndex.end()) {
+            continue; //operation is over already
         }
-        timer->tick(false); //false: did not send a frame prior to calling tick
-        if (timer->isExceeded()) {
-            AO_DBG_INFO("Discarding operation due to timeout:");
-            (*operation)->print_debug();
-            operation = initiatedOcppOperations.erase(operation);
+        if (std::find(rescheduled.begin(), rescheduled.end(), msgIdNum) != rescheduled.end()) {
+            continue; //duplicate entry. Operation has been processed in this loop already
+        }
+        auto operation = entry->second;
+
+        ulong due;
+        if (!(*operation)->getNextDue(due) || (long) (due - now) > 0) {
+            continue; //outdated entry. The operation has been rescheduled
+        }
+
+        if ((*operation)->isReqStarted()) {
+            boolean timeout = (*operation)->sendReq(ocppSock);
+            if (timeout) {
+                eraseInitiatedOperation(operation);
+                continue;
+            }
         } else {
-            ++operation;
+            Timeout *timer = (*operation)->getTimeout();
+            if (timer) {
+                timer->tick(false); //false: did not send a frame prior to calling tick
+                if (timer->isExceeded()) {
+                    AO_DBG_INFO("Discarding operation due to timeout:");
+                    (*operation)->print_debug();
+                    (*operation)->notifyTimeout();
+                    eraseInitiatedOperation(operation);
+                    continue;
+                }
+            }
         }
+
+        rescheduled.push_back(msgIdNum); //schedule after this loop, otherwise an operation could be due again immediately
     }
-    
+
+    for (auto msgIdNum : rescheduled) {
+        auto entry = initiatedOcppOperationsIndex.find(msgIdNum);
+        if (entry != initiatedOcppOperationsIndex.end()) {
+            scheduleOperation(**entry->second);
+        }
+    }
+    rescheduled.clear();
+
+    if (admissionPending) {
+        //timeouts made room for the next operations
+        admitOperations(ocppSock);
+    }
+
     /**
      * Work through the receivedOcppOperations queue. Start with the first element by calling conf() on it. 
      * If an ocppOperation is finished, it returns true on a conf() call, and is dequeued.
      */
 
-    operation = receivedOcppOperations.begin();
-    while (operation != receivedOcppOperations.end()){
-        boolean success = (*operation)->sendConf(ocppSock);
+    bool refused = false;
+
+    auto received = receivedOcppOperations.begin();
+    while (received != receivedOcppOperations.end()){
+        boolean success = (*received)->sendConf(ocppSock);
         if (success){
-            operation = receivedOcppOperations.erase(operation);
+            receivedBudget.remove((*received)->getBudgetedSize());
+            cacheConf(**received);
+            received = receivedOcppOperations.erase(received);
         } else {
             //There will be another attempt to send this conf message in a future loop call.
             //Go on with the next element in the queue, which is now at receivedOcppOperations[i+1]
-            ++operation; //TODO review: this makes confs out-of-order. But if the first Op fails because of lacking RAM, this could save the device. 
+            refused = true;
+            ++received; //TODO review: this makes confs out-of-order. But if the first Op fails because of lacking RAM, this could save the device. 
+        }
+    }
+
+    /*
+     * Answer repeated requests with the conf which has been sent already
+     */
+    for (auto& cached : confCache) {
+        if (cached.resend) {
+            bool success = false;
+            if (cached.binary) {
+                char *frame = ocppSock.reserveTXT(cached.frame.length());
+                if (frame) {
+                    memcpy(frame, cached.frame.data(), cached.frame.length());
+                    success = ocppSock.commitBIN(cached.frame.length());
+                }
+            } else {
+                AO_DBG_TRAFFIC_OUT(cached.frame.c_str());
+                success = ocppSock.sendTXT(cached.frame);
+            }
+            if (success) {
+                cached.resend = false;
+            } else {
+                refused = true;
+            }
         }
     }
+
+    /*
+     * If the socket refuses confs (e.g. offline), the host doesn't need to call loop() again before the retry
+     * interval has passed
+     */
+    confSendRefused = refused;
+    if (refused) {
+        confRetryDue = ao_tick_ms() + AO_CONF_RETRY_INTERVAL;
+    }
+}
+
+/*
+ * Up to AO_CALL_WINDOW operations may be in flight at the same time, i.e. sendReq() has been called on them and
+ * they wait for their confirmation. Operations of the same sequence channel (e.g. transaction-related messages of
+ * one connector) are never in flight at the same time. A later operation waits until all earlier operations of its
+ * channel are over.
+ * 
+ * With the default window size 1, this is the strict head-of-line blocking which OCPP-J prescribes.
+ */
+void OcppConnection::admitOperations(OcppSocket& ocppSock) {
+    admissionPending = false;
+
+    int callWindow = callWindowSize ? (int) *callWindowSize : 1;
+    if (callWindow < 1) {
+        callWindow = 1;
+    }
+
+    int inFlight = 0;
+    for (auto& operation : initiatedOcppOperations) {
+        if (operation->isReqStarted()) {
+            inFlight++;
+        }
+    }
+
+    uint32_t busyChannels = 0; //bit n set: channel n has an earlier operation which is still pending
+
+    auto operation = initiatedOcppOperations.begin();
+    while (operation != initiatedOcppOperations.end() && inFlight < callWindow) {
+        int channel = (*operation)->getSequenceChannel();
+        uint32_t channelBit = channel >= 0 ? 1UL << (channel % 32) : 0;
+
+        if (!(*operation)->isReqStarted() && !(busyChannels & channelBit)) {
+            Timeout *timer = (*operation)->getTimeout();
+            if (timer) {
+                timer->tick(false); //account for the time waiting in the queue
+            }
+            inFlight++;
+            (*operation)->setBinaryFraming(binaryPeer);
+            boolean timeout = (*operation)->sendReq(ocppSock);
+            if (timeout) {
+                inFlight--;
+                operation = eraseInitiatedOperation(operation);
+                continue;
+            }
+            scheduleOperation(**operation);
+        }
+
+        busyChannels |= channelBit;
+        ++operation;
+    }
+
+    admissionPending = false; //erasing operations above doesn't require another pass
+}
+
+void OcppConnection::scheduleOperation(OcppOperation& op) {
+    ScheduleEntry entry;
+    if (!op.getNextDue(entry.due)) {
+        return; //no deadline
+    }
+    entry.msgIdNum = op.getMessageIdNum();
+    schedule.push_back(entry);
+    std::push_heap(schedule.begin(), schedule.end(), ScheduleEntry::later);
+}
+
+unsigned long OcppConnection::nextWakeupMs() {
+    if (admissionPending || probePending) {
+        return 0;
+    }
+
+    unsigned long wakeup = AO_WAKEUP_NEVER;
+
+    bool confPending = !receivedOcppOperations.empty();
+    for (auto& cached : confCache) {
+        if (cached.resend) {
+            confPending = true;
+        }
+    }
+
+    if (confPending) {
+        if (!confSendRefused) {
+            return 0; //not attempted yet
+        }
+        long remaining = (long) (confRetryDue - ao_tick_ms());
+        if (remaining <= 0) {
+            return 0;
+        }
+        wakeup = (unsigned long) remaining;
+    }
+
+    if (!schedule.empty()) {
+        //the heap front can be stale (operation finished or rescheduled). Then loop() wakes up early and skips it
+        long remaining = (long) (schedule.front().due - ao_tick_ms());
+        if (remaining <= 0) {
+            return 0;
+        }
+        wakeup = std::min(wakeup, (unsigned long) remaining);
+    }
+
+    return wakeup;
 }
 
 void OcppConnection::initiateOcppOperation(std::unique_ptr<OcppOperation> o){
@@ -96,78 +324,215 @@ void OcppConnection::initiateOcppOperation(std::unique_ptr<OcppOperation> o){
         AO_DBG_ERR("Called without the operation being configured and ready to send. Discard operation!");
         return; //o gets destroyed
     }
-    o->setInitiated();
+
+    /*
+     * Keep the queue within its memory budget. Depending on the policy, older operations which haven't been sent
+     * yet make room for the new one, or the new operation is refused. Both cases are reported by onAbort
+     */
+    size_t opSize = o->getMemoryUsage();
+    if (!initiatedBudget.fits(opSize) && initiatedBudget.getPolicy() == BudgetPolicy::DropOldest) {
+        dropInitiatedOperations(opSize);
+    }
+    if (!initiatedBudget.fits(opSize)) {
+        AO_DBG_WARN("Initiated operations exceed memory budget. Reject new operation");
+        initiatedBudget.reportRejected();
+        o->drop();
+        return;
+    }
+    o->setBudgetedSize(opSize);
+    initiatedBudget.add(opSize);
+
+    int msgIdNum = nextMsgIdNum++;
+    o->setInitiated(msgIdNum);
     initiatedOcppOperations.push_back(std::move(o));
+    initiatedOcppOperationsIndex[msgIdNum] = std::prev(initiatedOcppOperations.end());
+    scheduleOperation(*initiatedOcppOperations.back()); //tick the timeout for the first time
+    admissionPending = true;
+}
+
+OcppConnection::InitiatedOperationsQueue::iterator OcppConnection::findInitiatedOperation(const char *msgId) {
+    /*
+     * This device issues purely numeric message IDs. Everything else cannot belong to an initiated operation
+     */
+    char *msgIdEnd = nullptr;
+    long msgIdNum = strtol(msgId, &msgIdEnd, 10);
+    if (msgIdEnd == msgId || *msgIdEnd != '\0' || msgIdNum < 0 || msgIdNum > INT_MAX) {
+        return initiatedOcppOperations.end();
+    }
+
+    auto entry = initiatedOcppOperationsIndex.find((int) msgIdNum);
+    if (entry == initiatedOcppOperationsIndex.end()) {
+        return initiatedOcppOperations.end();
+    }
+    return entry->second;
+}
+
+OcppConnection::InitiatedOperationsQueue::iterator OcppConnection::eraseInitiatedOperation(InitiatedOperationsQueue::iterator operation) {
+    initiatedOcppOperationsIndex.erase((*operation)->getMessageIdNum());
+    initiatedBudget.remove((*operation)->getBudgetedSize());
+    admissionPending = true; //schedule entries of the operation become outdated and are skipped
+    return initiatedOcppOperations.erase(operation);
+}
+
+void OcppConnection::dropInitiatedOperations(size_t requiredBytes) {
+    auto operation = initiatedOcppOperations.begin();
+    while (operation != initiatedOcppOperations.end() && !initiatedBudget.fits(requiredBytes)) {
+        if ((*operation)->isDroppable()) {
+            (*operation)->drop();
+            initiatedBudget.reportDropped();
+            operation = eraseInitiatedOperation(operation);
+        } else {
+            ++operation;
+        }
+    }
 }
 
 bool OcppConnection::processOcppSocketInputTXT(const char* payload, size_t length) {
-    
-    boolean deserializationSuccess = false;
 
-    auto doc = std::unique_ptr<DynamicJsonDocument>{nullptr};
-    size_t capacity = length + 100;
+    /*
+     * Read the RPC header first, without allocating. CALLRESULTs and CALLERRORs which don't belong to a pending
+     * operation and requests which this controller doesn't support are dropped or answered right away, so their
+     * payload is never deserialized. If the header can't be scanned (e.g. escaped characters), the whole frame is
+     * deserialized as before
+     */
+    RpcHeader header;
+    bool headerScanned = scanRpcHeader(payload, length, header);
+    std::unique_ptr<OcppOperation> reqOp;
 
-    DeserializationError err = DeserializationError::NoMemory;
-    while (capacity + HEAP_GUARD < ao_avail_heap() && err == DeserializationError::NoMemory) {
-        doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(capacity));
-        err = deserializeJson(*doc, payload, length);
+    if (headerScanned) {
+        switch (header.messageTypeId) {
+            case MESSAGE_TYPE_CALL:
+                if (isRepeatedReq(header.msgId)) {
+                    return true;
+                }
+                if (!receivedBudget.fits(length)) {
+                    AO_DBG_WARN("Incoming requests exceed memory budget. Reject %s", header.action);
+                    receivedBudget.reportRejected();
+                    handleReqHeader(header, makeOcppOperation(new OutOfMemory(ao_avail_heap(), length)));
+                    return true;
+                }
+                reqOp = operationFactory.makeOcppOperation(header.actionId);
+                if (reqOp == nullptr) {
+                    AO_DBG_WARN("Couldn't make OppOperation from Request. Ignore request");
+                    return false;
+                }
+                if (!reqOp->needsReqPayload()) {
+                    handleReqHeader(header, std::move(reqOp), length);
+                    return true;
+                }
+                break;
+            case MESSAGE_TYPE_CALLRESULT:
+            case MESSAGE_TYPE_CALLERROR:
+                if (findInitiatedOperation(header.msgId) == initiatedOcppOperations.end()) {
+                    AO_DBG_WARN("Received %s doesn't match any pending operation. Drop without parsing",
+                            header.messageTypeId == MESSAGE_TYPE_CALLRESULT ? "CALLRESULT" : "CALLERROR");
+                    return true;
+                }
+                break;
+            default:
+                AO_DBG_WARN("Invalid OCPP message! Unknown message type %i", header.messageTypeId);
+                return false;
+        }
+    }
+
+    /*
+     * Deserialize into the preallocated parse arena. deserializeJson() resets it, so the memory of the previous
+     * message is reused. If the message does not fit, it is not parsed a second time with a bigger document
+     */
+    DeserializationError err = deserializeJson(parseArena, payload, length);
+
+    if (err == DeserializationError::NoMemory && !headerScanned) {
+        AO_DBG_WARN("OOP! Incoming operation exceeds parse arena. Input length = %zu, arena size = %zu", length, parseArena.capacity());
+        parseArena.clear();
+        return rejectOversizedReq(payload, length);
+    }
+
+    return processParsedMessage(err, length, headerScanned ? &header : nullptr, std::move(reqOp));
+}
+
+bool OcppConnection::processOcppSocketInputBIN(const uint8_t* payload, size_t length) {
+
+    FramingMode mode = getFramingMode();
+    if (mode == FramingMode::Off) {
+        AO_DBG_WARN("Received binary frame, but MessagePack framing is off (see AO_FRAMING). Ignore");
+        return false;
+    }
 
-        capacity /= 2;
-        capacity *= 3;
+    /*
+     * The RPC header is not scanned in advance. MessagePack frames are parsed completely, which is cheap
+     * compared to JSON because strings and numbers are length-prefixed
+     */
+    DeserializationError err = deserializeMsgPack(parseArena, (const char*) payload, length);
+
+    if (!err && parseArena.is<JsonArray>() && parseArena.size() == 1 && (parseArena[0] | -1) == MESSAGE_TYPE_FRAMING_PROBE) {
+        AO_DBG_DEBUG("Other end accepts MessagePack framing");
+        if (!binaryPeer && !probeSent) {
+            probePending = true; //answer the offer
+        }
+        binaryPeer = true;
+        parseArena.clear();
+        return true;
     }
 
-    //TODO insert validateRpcHeader at suitable position
+    binaryPeer = true;
+    binaryInput = true;
+    bool success = processParsedMessage(err, length, nullptr, nullptr);
+    binaryInput = false;
+    return success;
+}
+
+/*
+ * Dispatches the message in the parse arena. header is the RPC header if it has been scanned before
+ * deserialization, otherwise nullptr. reqOp is the operation which has been created from the header already
+ */
+bool OcppConnection::processParsedMessage(DeserializationError err, size_t length, const RpcHeader *header, std::unique_ptr<OcppOperation> reqOp) {
+
+    boolean deserializationSuccess = false;
 
     switch (err.code()) {
-        case DeserializationError::Ok:
-            if (doc != nullptr){
-                int messageTypeId = (*doc)[0] | -1;
-                switch(messageTypeId) {
-                    case MESSAGE_TYPE_CALL:
-                        handleReqMessage(*doc);      
-                        deserializationSuccess = true;
-                        break;
-                    case MESSAGE_TYPE_CALLRESULT:
-                        handleConfMessage(*doc);
-                        deserializationSuccess = true;
-                        break;
-                    case MESSAGE_TYPE_CALLERROR:
-                        handleErrMessage(*doc);
-                        deserializationSuccess = true;
-                        break;
-                    default:
-                        AO_DBG_WARN("Invalid OCPP message! (though JSON has successfully been deserialized)");
-                        break;
-                }
-            } else { //unlikely corner case
-                AO_DBG_ERR("Deserialization is okay but doc is nullptr");
+        case DeserializationError::Ok: {
+            int messageTypeId = parseArena[0] | -1;
+            switch(messageTypeId) {
+                case MESSAGE_TYPE_CALL:
+                    if (reqOp) {
+                        handleReqMessage(parseArena, std::move(reqOp), length);
+                    } else if (receivedBudget.fits(length)) {
+                        handleReqMessage(parseArena, length);
+                    } else {
+                        AO_DBG_WARN("Incoming requests exceed memory budget. Reject request");
+                        receivedBudget.reportRejected();
+                        handleReqMessage(parseArena, makeOcppOperation(new OutOfMemory(ao_avail_heap(), length)));
+                    }
+                    deserializationSuccess = true;
+                    break;
+                case MESSAGE_TYPE_CALLRESULT:
+                    handleConfMessage(parseArena);
+                    deserializationSuccess = true;
+                    break;
+                case MESSAGE_TYPE_CALLERROR:
+                    handleErrMessage(parseArena);
+                    deserializationSuccess = true;
+                    break;
+                default:
+                    AO_DBG_WARN("Invalid OCPP message! (though JSON has successfully been deserialized)");
+                    break;
             }
             break;
+        }
         case DeserializationError::InvalidInput:
-            AO_DBG_WARN("Invalid input! Not a JSON");
+            AO_DBG_WARN("Invalid input! Not a JSON or MessagePack message");
             break;
         case DeserializationError::NoMemory:
-            {
-                AO_DBG_WARN("OOP! Incoming operation exceeds reserved heap. Input length = %zu, free heap = %u", length, ao_avail_heap());
-
-                /*
-                 * If websocket input is of message type MESSAGE_TYPE_CALL, send back a message of type MESSAGE_TYPE_CALLERROR.
-                 * Then the communication counterpart knows that this operation failed.
-                 * If the input type is MESSAGE_TYPE_CALLRESULT, it can be ignored. This controller will automatically resend the corresponding request message.
-                 */
-
-                doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(200));
-                char onlyRpcHeader[200];
-                size_t onlyRpcHeader_len = removePayload(payload, length, onlyRpcHeader, sizeof(onlyRpcHeader));
-                DeserializationError err2 = deserializeJson(*doc, onlyRpcHeader, onlyRpcHeader_len);
-                if (err2.code() == DeserializationError::Ok) {
-                    int messageTypeId2 = (*doc)[0] | -1;
-                    if (messageTypeId2 == MESSAGE_TYPE_CALL) {
-                        deserializationSuccess = true;
-                        auto op = makeOcppOperation(new OutOfMemory(ao_avail_heap(), length));
-                        handleReqMessage(*doc, std::move(op));
-                    }
-                }
+            AO_DBG_WARN("OOP! Incoming operation exceeds parse arena. Input length = %zu, arena size = %zu", length, parseArena.capacity());
+
+            /*
+             * If websocket input is of message type MESSAGE_TYPE_CALL, send back a message of type MESSAGE_TYPE_CALLERROR.
+             * Then the communication counterpart knows that this operation failed.
+             * If the input type is MESSAGE_TYPE_CALLRESULT, it can be ignored. This controller will automatically resend the corresponding request message.
+             */
+            if (header && header->messageTypeId == MESSAGE_TYPE_CALL) {
+                deserializationSuccess = true;
+                handleReqHeader(*header, makeOcppOperation(new OutOfMemory(ao_avail_heap(), length)));
             }
             break;
         default:
@@ -175,21 +540,144 @@ bool OcppConnection::processOcppSocketInputTXT(const char* payload, size_t lengt
             break;
     }
 
+    parseArena.clear();
+
     return deserializationSuccess;
 }
 
+/*
+ * Tries to recover the RPC header from a frame which doesn't fit into the parse arena, if scanRpcHeader() couldn't
+ * read it. This is the case for message IDs with escaped characters, for instance.
+ * 
+ * Example input: 
+ * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {"key":"now the msg is too long...
+ * 
+ * The frame is copied up to the first occurence of the character '{', and "}]" is written after it:
+ * 
+ * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {}]
+ * 
+ * If this is a CALL, it is answered with an OutOfMemory CallError. Then the communication counterpart knows that
+ * this operation failed. CALLRESULTs are ignored; this controller will resend the corresponding request message.
+ */
+bool OcppConnection::rejectOversizedReq(const char *payload, size_t length) {
+    char onlyRpcHeader [200];
+    size_t onlyRpcHeaderLen = 0;
+    for (size_t i = 0; i < length && i + 3 < sizeof(onlyRpcHeader); i++) {
+        if (payload[i] == '\0') {
+            break; //no payload within specified range
+        }
+        onlyRpcHeader[i] = payload[i];
+        if (payload[i] == '{') {
+            onlyRpcHeader[i + 1] = '}';
+            onlyRpcHeader[i + 2] = ']';
+            onlyRpcHeaderLen = i + 3;
+            break;
+        }
+    }
+
+    if (onlyRpcHeaderLen == 0) {
+        return false;
+    }
+
+    StaticJsonDocument<JSON_ARRAY_SIZE(4) + JSON_OBJECT_SIZE(0)> headerDoc; //strings stay in onlyRpcHeader (zero-copy)
+    DeserializationError err = deserializeJson(headerDoc, onlyRpcHeader, onlyRpcHeaderLen);
+    if (err || (headerDoc[0] | -1) != MESSAGE_TYPE_CALL || !headerDoc[1].is<const char*>()) {
+        return false;
+    }
+
+    handleReqMessage(headerDoc, makeOcppOperation(new OutOfMemory(ao_avail_heap(), length)));
+    return true;
+}
+
+/*
+ * Reads the RPC header of an OCPP-J frame in place. Example inputs:
+ * 
+ * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {"key":...
+ * [3, "19223201", {"status":...
+ * 
+ * Returns false if the header can't be read without unescaping or if the strings exceed the header buffers. The
+ * remainder of the frame is not validated; that is left to the JSON deserializer.
+ */
+bool OcppConnection::scanRpcHeader(const char *src, size_t len, RpcHeader& header) {
+    size_t i = 0;
+
+    auto skipWhitespace = [&] () {
+        while (i < len && (src[i] == ' ' || src[i] == '\t' || src[i] == '\n' || src[i] == '\r')) {
+            i++;
+        }
+    };
+
+    auto expect = [&] (char c) -> bool {
+        skipWhitespace();
+        if (i >= len || src[i] != c) {
+            return false;
+        }
+        i++;
+        return true;
+    };
+
+    auto readString = [&] (char *dst, size_t dst_size) -> bool {
+        if (!expect('"')) {
+            return false;
+        }
+        size_t n = 0;
+        for (; i < len && src[i] != '"'; i++) {
+            if (src[i] == '\\' || src[i] == '\0' || n + 1 >= dst_size) {
+                return false;
+            }
+            dst[n++] = src[i];
+        }
+        if (i >= len) {
+            return false;
+        }
+        dst[n] = '\0';
+        i++; //closing quote
+        return true;
+    };
+
+    if (!expect('[')) {
+        return false;
+    }
+
+    skipWhitespace();
+    if (i >= len || src[i] < '0' || src[i] > '9') {
+        return false;
+    }
+    header.messageTypeId = src[i] - '0';
+    i++;
+    if (i < len && src[i] >= '0' && src[i] <= '9') {
+        return false; //message types have one digit
+    }
+
+    if (!expect(',') || !readString(header.msgId, sizeof(header.msgId))) {
+        return false;
+    }
+
+    header.action[0] = '\0';
+    header.actionId = OcppAction::Unknown;
+    if (header.messageTypeId == MESSAGE_TYPE_CALL) {
+        if (!expect(',') || !readString(header.action, sizeof(header.action))) {
+            return false;
+        }
+        header.actionId = getOcppAction(header.action);
+    }
+
+    return true;
+}
+
 /**
- * call conf() on each element of the queue. Start with first element. On successful message delivery,
- * delete the element from the list. Try all the pending OCPP Operations until the right one is found.
+ * Look up the pending OcppOperation by the message ID of the CALLRESULT and call conf() on it. On successful
+ * message delivery, delete the element from the list.
  * 
  * This function could result in improper behavior in Charging Stations, because messages are not
  * guaranteed to be received and therefore processed in the right order.
  */
 void OcppConnection::handleConfMessage(JsonDocument& json) {
-    for (auto operation = initiatedOcppOperations.begin(); operation != initiatedOcppOperations.end(); ++operation) {
+    auto operation = findInitiatedOperation(json[1] | "");
+    if (operation != initiatedOcppOperations.end()) {
         boolean success = (*operation)->receiveConf(json); //maybe rename to "consumed"?
         if (success) {
-            initiatedOcppOperations.erase(operation);
+            eraseInitiatedOperation(operation);
             return;
         }
     }
@@ -198,67 +686,126 @@ void OcppConnection::handleConfMessage(JsonDocument& json) {
     AO_DBG_WARN("Received CALLRESULT doesn't match any pending operation");
 }
 
-void OcppConnection::handleReqMessage(JsonDocument& json) {
-    auto op = makeFromJson(json);
+void OcppConnection::handleReqMessage(JsonDocument& json, size_t budgetedSize) {
+    if (isRepeatedReq(json[1] | "")) {
+        return;
+    }
+
+    auto op = operationFactory.makeFromJson(json);
     if (op == nullptr) {
         AO_DBG_WARN("Couldn't make OppOperation from Request. Ignore request");
         return;
     }
-    handleReqMessage(json, std::move(op));
+    handleReqMessage(json, std::move(op), budgetedSize);
 }
 
-void OcppConnection::handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOperation> op) {
+void OcppConnection::handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOperation> op, size_t budgetedSize) {
     if (op == nullptr) {
         AO_DBG_ERR("Invalid argument");
         return;
     }
     op->setOcppModel(baseModel);
+    op->setBinaryFraming(binaryInput); //answer with the framing of the request
     op->receiveReq(json); //"fire" the operation
+
+    /*
+     * The budget has been checked with the frame length before the request was processed, so the same measure is
+     * accounted here. CallErrors which reject a request are added in any case with 0 bytes, otherwise the server
+     * couldn't be informed
+     */
+    op->setBudgetedSize(budgetedSize);
+    receivedBudget.add(op->getBudgetedSize());
     receivedOcppOperations.push_back(std::move(op)); //enqueue so loop() plans conf sending
+    confSendRefused = false; //attempt in the next loop
 }
 
-void OcppConnection::handleErrMessage(JsonDocument& json) {
-    for (auto operation = initiatedOcppOperations.begin(); operation != initiatedOcppOperations.end(); ++operation){
-        boolean discardOperation = (*operation)->receiveError(json); //maybe rename to "consumed"?
-        if (discardOperation) {
-            initiatedOcppOperations.erase(operation);
-            return;
+void OcppConnection::handleReqHeader(const RpcHeader& header, std::unique_ptr<OcppOperation> op, size_t budgetedSize) {
+    /*
+     * The operation only answers with an error, so it gets the header with an empty payload. The strings are
+     * not copied into the document; header outlives it
+     */
+    StaticJsonDocument<JSON_ARRAY_SIZE(4) + JSON_OBJECT_SIZE(0)> headerDoc;
+    headerDoc.add(MESSAGE_TYPE_CALL);
+    headerDoc.add((const char*) header.msgId);
+    headerDoc.add((const char*) header.action);
+    headerDoc.createNestedObject();
+    handleReqMessage(headerDoc, std::move(op), budgetedSize);
+}
+
+/*
+ * The server repeats a request if it didn't receive the conf. Do not execute such requests a second time, but
+ * send the conf once again
+ */
+bool OcppConnection::isRepeatedReq(const char *msgId) {
+
+    for (auto& received : receivedOcppOperations) {
+        if (!strcmp(received->getMessageID()->c_str(), msgId)) {
+            AO_DBG_INFO("Received request %s again while it is still in progress. Ignore", msgId);
+            return true;
         }
     }
 
-    //No OcppOperation was aborted because of the error message
-    AO_DBG_WARN("Received CALLERROR did not abort a pending operation");
+    for (auto& cached : confCache) {
+        if (!strcmp(cached.messageID.c_str(), msgId)) {
+            AO_DBG_INFO("Received request %s again. Resend conf", msgId);
+            cached.resend = true;
+            confSendRefused = false; //attempt in the next loop
+            return true;
+        }
+    }
+
+    return false;
 }
 
 /*
- * Tries to recover the Ocpp-Operation header from a broken message.
+ * OCPP-J message IDs are only unique within one WebSocket connection. After a reconnect, the server may use the ID
+ * of a cached conf for a new request, which must be executed and not be answered from the cache.
  * 
- * Example input: 
- * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {"key":"now the msg breaks...
- * 
- * The Json library returns an error code when trying to deserialize that broken message. This
- * function searches for the first occurence of the character '{' and writes "}]" after it.
- * 
- * Example output:
- * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {}]
- *
+ * The other end may also be a different or restarted counterpart which only speaks text. The framing is
+ * negotiated again, and requests are sent as text until the other end accepts MessagePack
  */
-size_t removePayload(const char *src, size_t src_size, char *dst, size_t dst_size) {
-    size_t res_len = 0;
-    for (size_t i = 0; i < src_size && i < dst_size-3; i++) {
-        if (src[i] == '\0'){
-            //no payload found within specified range. Cancel execution
-            break;
-        }
-        dst[i] = src[i];
-        if (src[i] == '{') {
-            dst[i+1] = '}';
-            dst[i+2] = ']';
-            res_len = i+3;
-            break;
+void OcppConnection::processOcppSocketConnectionState(bool connected) {
+    AO_DBG_DEBUG("Socket %s. Reset conf cache and framing", connected ? "connected" : "disconnected");
+    confCache.clear();
+
+    binaryPeer = false;
+    probeSent = false;
+    probePending = connected && getFramingMode() == FramingMode::Prefer;
+    for (auto& operation : initiatedOcppOperations) {
+        operation->setBinaryFraming(false);
+    }
+}
+
+void OcppConnection::cacheConf(OcppOperation& op) {
+    if (AO_CONF_CACHE_SIZE <= 0) {
+        return;
+    }
+
+    CachedConf entry;
+    if (!op.releaseConfFrame(entry.frame) || entry.frame.length() > AO_CONF_CACHE_MAXLEN) {
+        return; //only cache successful confs of moderate size
+    }
+    entry.messageID = *op.getMessageID();
+    entry.binary = op.isBinaryFraming();
+
+    while (confCache.size() >= (size_t) AO_CONF_CACHE_SIZE) {
+        confCache.pop_front();
+    }
+    confCache.push_back(std::move(entry));
+}
+
+void OcppConnection::handleErrMessage(JsonDocument& json) {
+    auto operation = findInitiatedOperation(json[1] | "");
+    if (operation != initiatedOcppOperations.end()) {
+        boolean discardOperation = (*operation)->receiveError(json); //maybe rename to "consumed"?
+        if (discardOperation) {
+            eraseInitiatedOperation(operation);
+            return;
         }
+        scheduleOperation(**operation); //operation restarts
+        return;
     }
-    dst[res_len] = '\0';
-    res_len++;
-    return res_len;
+
+    //No OcppOperation was aborted because of the error message
+    AO_DBG_WARN("Received CALLERROR did not abort a pending operation");
 }
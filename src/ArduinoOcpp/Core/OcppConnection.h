@@ -6,34 +6,188 @@
 #define OCPPCONNECTION_H
 
 #include <deque>
+#include <list>
+#include <unordered_map>
+#include <vector>
 #include <memory>
+#include <string>
 #include <ArduinoJson.h>
 
+#include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+#include <ArduinoOcpp/Core/MemoryBudget.h>
+#include <ArduinoOcpp/Core/OcppAction.h>
+#include <ArduinoOcpp/Platform.h>
+
+#ifndef AO_CONF_CACHE_SIZE
+#define AO_CONF_CACHE_SIZE 3 //number of recently sent confs which are kept to answer repeated requests
+#endif
+
+#ifndef AO_CONF_CACHE_MAXLEN
+#define AO_CONF_CACHE_MAXLEN 512 //longer confs are not cached. The repeated request will be executed again
+#endif
+
+#ifndef AO_CONF_RETRY_INTERVAL
+#define AO_CONF_RETRY_INTERVAL 3000 //in ms; if the socket refuses a conf, nextWakeupMs() schedules the next attempt after this interval
+#endif
+
+#ifndef AO_INITIATED_OPS_MAX
+#define AO_INITIATED_OPS_MAX 20 //default quota of operations which this device has initiated and which are not finished yet
+#endif
+
+#ifndef AO_INITIATED_OPS_BYTES
+#define AO_INITIATED_OPS_BYTES 8192 //default quota of heap usage by initiated operations
+#endif
+
+#ifndef AO_INITIATED_OPS_POLICY
+#define AO_INITIATED_OPS_POLICY BudgetPolicy::DropOldest //what to do with new operations if the quota is exceeded
+#endif
+
+#ifndef AO_RECEIVED_OPS_MAX
+#define AO_RECEIVED_OPS_MAX 5 //default quota of incoming requests whose conf hasn't been sent yet
+#endif
+
+#ifndef AO_RECEIVED_OPS_BYTES
+#define AO_RECEIVED_OPS_BYTES 4096 //default quota of incoming requests whose conf hasn't been sent yet, measured by their frame length
+#endif
+
+#ifndef AO_PARSE_ARENA_SIZE
+#define AO_PARSE_ARENA_SIZE 4096 //memory budget for deserializing incoming messages. Preallocated once per connection
+#endif
+
 namespace ArduinoOcpp {
 
+/*
+ * Framing of the OCPP-J messages. MessagePack frames have the same structure as the JSON text frames (e.g.
+ * [2, "<msgId>", "<action>", {<payload>}]), but are sent as binary WebSocket frames. This is meant for local links
+ * between engines, e.g. between a charge controller and a gateway; OCPP-J itself only specifies text frames.
+ * 
+ *     Off:    only text frames. Incoming binary frames are rejected
+ *     Accept: send text frames until the other end has sent a binary frame, then MessagePack. Requests are always
+ *             answered with the framing of the request
+ *     Prefer: like Accept, but offer MessagePack by sending a probe frame once. A counterpart in Off mode ignores it
+ */
+enum class FramingMode {
+    Off = 0,
+    Accept = 1,
+    Prefer = 2
+};
+
+#ifndef AO_FRAMING_MODE
+#define AO_FRAMING_MODE FramingMode::Off //default of the configuration AO_FRAMING
+#endif
+
 class OcppModel;
 class OcppSocket;
 class OcppOperation;
+class OcppOperationFactory;
 
 class OcppConnection {
 private:
     std::shared_ptr<OcppModel> baseModel;
+    OcppOperationFactory& operationFactory;
+
+    std::shared_ptr<Configuration<int>> callWindowSize; //max number of CALLs which are awaiting their response at the same time
+    std::shared_ptr<Configuration<int>> framingMode; //see FramingMode
+
+    bool binaryPeer = false; //true after the other end has sent a binary frame on this connection. Then requests are sent as MessagePack
+    bool binaryInput = false; //true while a binary frame is processed, so that the conf is sent as MessagePack too
+    bool probePending = false; //send the MessagePack probe frame in the next loop
+    bool probeSent = false;
+
+    FramingMode getFramingMode();
+    bool sendProbe(OcppSocket& ocppSock);
     
-    std::deque<std::unique_ptr<OcppOperation>> initiatedOcppOperations;
+    using InitiatedOperationsQueue = std::list<std::unique_ptr<OcppOperation>>;
+
+    InitiatedOperationsQueue initiatedOcppOperations;
+    std::unordered_map<int, InitiatedOperationsQueue::iterator> initiatedOcppOperationsIndex; //key: numeric message ID
+    int nextMsgIdNum = 1000000; //numeric message ID of the next initiated operation
     std::deque<std::unique_ptr<OcppOperation>> receivedOcppOperations;
 
+    /*
+     * Min-heap of the next retry / timeout deadlines of the initiated operations. Entries of finished operations or
+     * outdated entries of rescheduled operations remain in the heap until they are due and are skipped then.
+     */
+    struct ScheduleEntry {
+        ulong due;
+        int msgIdNum;
+        static bool later(const ScheduleEntry& a, const ScheduleEntry& b) {return (long) (a.due - b.due) > 0;}
+    };
+    std::vector<ScheduleEntry> schedule;
+    std::vector<int> rescheduled; //operations which have been processed in the current loop
+    QueueBudget initiatedBudget;
+    QueueBudget receivedBudget;
+    void dropInitiatedOperations(size_t requiredBytes); //discard the oldest droppable operations until requiredBytes fit
+
+    bool admissionPending = false; //true if the queue has changed and more operations may be started
+
+    void scheduleOperation(OcppOperation& op);
+    void admitOperations(OcppSocket& ocppSock);
+
+    DynamicJsonDocument parseArena {AO_PARSE_ARENA_SIZE}; //reused for every incoming message
+
+    struct CachedConf {
+        std::string messageID;
+        std::string frame;
+        bool resend = false; //true if the server repeated the request and the conf must be sent again
+        bool binary = false; //MessagePack frame
+    };
+    std::deque<CachedConf> confCache;
+
+    bool confSendRefused = false; //true if the socket refused a conf in the last loop. Cleared when a new conf is pending
+    ulong confRetryDue = 0; //if confSendRefused: when the next attempt is due
+
+    bool isRepeatedReq(const char *msgId);
+    void cacheConf(OcppOperation& op);
+
+    InitiatedOperationsQueue::iterator findInitiatedOperation(const char *msgId); //look up the operation which the CALLRESULT / CALLERROR refers to
+    InitiatedOperationsQueue::iterator eraseInitiatedOperation(InitiatedOperationsQueue::iterator operation);
+
+    /*
+     * RPC header of an incoming frame, read before the payload is deserialized. Strings longer than the buffers
+     * are not scanned; such frames take the path of complete deserialization
+     */
+    struct RpcHeader {
+        int messageTypeId;
+        char msgId [64]; //OCPP-J message IDs have at most 36 characters
+        char action [64]; //only set for CALLs
+        OcppAction actionId; //action, interned while scanning
+    };
+    static bool scanRpcHeader(const char *src, size_t len, RpcHeader& header);
+
+    void handleReqHeader(const RpcHeader& header, std::unique_ptr<OcppOperation> op, size_t budgetedSize = 0); //handle request without its payload
+
+    bool rejectOversizedReq(const char *payload, size_t length); //answer a CALL which exceeds the parse arena and whose header couldn't be scanned
+
+    bool processParsedMessage(DeserializationError err, size_t length, const RpcHeader *header, std::unique_ptr<OcppOperation> reqOp);
+
     void handleConfMessage(JsonDocument& json);
-    void handleReqMessage(JsonDocument& json);
-    void handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOperation> op);
+    /*
+     * budgetedSize: the amount which the request is accounted with in the received budget, i.e. its frame length.
+     * 0 for CallErrors which reject a request
+     */
+    void handleReqMessage(JsonDocument& json, size_t budgetedSize);
+    void handleReqMessage(JsonDocument& json, std::unique_ptr<OcppOperation> op, size_t budgetedSize = 0);
     void handleErrMessage(JsonDocument& json);
 public:
-    OcppConnection(OcppSocket& oSock, std::shared_ptr<OcppModel> baseModel);
+    OcppConnection(OcppSocket& oSock, std::shared_ptr<OcppModel> baseModel, OcppOperationFactory& operationFactory);
 
     void loop(OcppSocket& oSock);
 
+    unsigned long nextWakeupMs(); //time until the next retry or timeout is due; 0 if there is work left for loop()
+
     void initiateOcppOperation(std::unique_ptr<OcppOperation> o);
     
     bool processOcppSocketInputTXT(const char* payload, size_t length);
+
+    bool processOcppSocketInputBIN(const uint8_t* payload, size_t length);
+
+    void processOcppSocketConnectionState(bool connected); //resets the conf cache and the framing negotiation
+
+    bool isBinaryPeer() const {return binaryPeer;}
+
+    QueueBudgetStatus getInitiatedBudgetStatus() const {return initiatedBudget.getStatus();}
+    QueueBudgetStatus getReceivedBudgetStatus() const {return receivedBudget.getStatus();}
 };
 
 } //end namespace ArduinoOcpp
@@ -6,21 +6,27 @@
 #include <ArduinoOcpp/Core/OcppOperation.h>
 #include <ArduinoOcpp/Core/OcppSocket.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+
+#include <algorithm>
 
 using namespace ArduinoOcpp;
 
-OcppEngine *ArduinoOcpp::defaultOcppEngine = nullptr;
+OcppEngine::OcppEngine(OcppSocket& ocppSocket, const OcppClock& system_clock, std::shared_ptr<ConfigurationStore> configurationStore)
+        : oSock(ocppSocket),
+          oModel{std::make_shared<OcppModel>(system_clock, configurationStore ? configurationStore : getDefaultConfigurationStore())},
+          operationFactory{*this},
+          oConn{oSock, oModel, operationFactory} {
 
-OcppEngine::OcppEngine(OcppSocket& ocppSocket, const OcppClock& system_clock)
-        : oSock(ocppSocket), oModel{std::make_shared<OcppModel>(system_clock)}, oConn{oSock, oModel} {
-    defaultOcppEngine = this;
 }
 
-OcppEngine::~OcppEngine() {
-    defaultOcppEngine = nullptr;
-}
+OcppEngine::~OcppEngine() = default;
 
 void OcppEngine::loop() {
+#ifdef AO_COMMAND_QUEUE
+    commandQueue.runAll();
+#endif
+
     oSock.loop();
     oConn.loop(oSock);
 
@@ -28,6 +34,21 @@ void OcppEngine::loop() {
         oModel->loop();
 }
 
+unsigned long OcppEngine::nextWakeupMs() {
+#ifdef AO_COMMAND_QUEUE
+    if (!commandQueue.empty()) {
+        return 0;
+    }
+#endif
+
+    unsigned long wakeup = oConn.nextWakeupMs();
+
+    if (runOcppTasks)
+        wakeup = std::min(wakeup, oModel->nextWakeupMs());
+
+    return wakeup;
+}
+
 void OcppEngine::initiateOperation(std::unique_ptr<OcppOperation> op) {
     if (op) {
         op->setOcppModel(oModel);
@@ -38,3 +59,7 @@ void OcppEngine::initiateOperation(std::unique_ptr<OcppOperation> op) {
 OcppModel& OcppEngine::getOcppModel() {
     return *oModel;
 }
+
+ConfigurationStore& OcppEngine::getConfigurationStore() {
+    return oModel->getConfigurationStore();
+}
@@ -7,34 +7,71 @@
 
 #include <ArduinoOcpp/Core/OcppConnection.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <memory>
 
+#ifdef AO_COMMAND_QUEUE
+#include <ArduinoOcpp/Core/CommandQueue.h>
+#endif
+
 namespace ArduinoOcpp {
 
 class OcppSocket;
 class OcppModel;
+class ConfigurationStore;
 
 class OcppEngine {
 private:
     OcppSocket& oSock;
     std::shared_ptr<OcppModel> oModel;
+    OcppOperationFactory operationFactory;
     OcppConnection oConn;
 
     bool runOcppTasks = true;
+
+#ifdef AO_COMMAND_QUEUE
+    CommandQueue commandQueue;
+#endif
 public:
-    OcppEngine(OcppSocket& ocppSocket, const OcppClock& system_clock);
+    /*
+     * Every engine is a separate charge point. If configurationStore is null, the engine uses the default store which
+     * the free configuration functions (declareConfiguration(), configuration_init() etc.) operate on. To run several
+     * charge points in one process, pass a separate store to each engine
+     */
+    OcppEngine(OcppSocket& ocppSocket, const OcppClock& system_clock, std::shared_ptr<ConfigurationStore> configurationStore = nullptr);
     ~OcppEngine();
 
     void loop();
 
+    /*
+     * Returns the time in ms until loop() has work to do, or AO_WAKEUP_NEVER if no OCPP timer is running. This only
+     * covers the timers of the library. Incoming WebSocket data and changes of the samplers (e.g. plug state) are not
+     * predictable, so the host must still service the socket and call loop() after it detects such events
+     */
+    unsigned long nextWakeupMs();
+
     void setRunOcppTasks(bool enable) {runOcppTasks = enable;}
 
+#ifdef AO_COMMAND_QUEUE
+    /*
+     * Thread-safe: enqueues a command which loop() executes on the engine thread before it services the socket.
+     * This is the only function of the engine which may be called from other threads. Results can be handed
+     * back from within the command, e.g. via a callback of the caller
+     */
+    void post(CommandQueue::Command command) {commandQueue.push(std::move(command));}
+#endif
+
     void initiateOperation(std::unique_ptr<OcppOperation> op);
 
+    QueueBudgetStatus getInitiatedBudgetStatus() const {return oConn.getInitiatedBudgetStatus();}
+    QueueBudgetStatus getReceivedBudgetStatus() const {return oConn.getReceivedBudgetStatus();}
+
     OcppModel& getOcppModel();
-};
 
-extern OcppEngine *defaultOcppEngine;
+    OcppOperationFactory& getOperationFactory() {return operationFactory;}
+
+    ConfigurationStore& getConfigurationStore();
+};
 
 } //end namespace ArduinoOcpp
 
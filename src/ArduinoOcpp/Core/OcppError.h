@@ -13,9 +13,15 @@ namespace ArduinoOcpp {
 
 class NotImplemented : public OcppMessage {
 public:
+    const char* getOcppOperationType() {
+        return "NotImplemented";
+    }
     const char *getErrorCode() {
         return "NotImplemented";
     }
+    bool needsReqPayload() {
+        return false;
+    }
 };
 
 class OutOfMemory : public OcppMessage {
@@ -24,12 +30,18 @@ private:
     size_t msgLen;
 public:
     OutOfMemory(uint32_t freeHeap, size_t msgLen) : freeHeap(freeHeap), msgLen(msgLen) { }
+    const char* getOcppOperationType() {
+        return "OutOfMemory";
+    }
     const char *getErrorCode() {
         return "InternalError";
     }
     const char *getErrorDescription() {
         return "Too little free memory on the controller. Operation denied";
     }
+    bool needsReqPayload() {
+        return false;
+    }
     std::unique_ptr<DynamicJsonDocument> getErrorDetails() {
         auto errDoc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(2)));
         JsonObject err = errDoc->to<JsonObject>();
@@ -44,6 +56,9 @@ private:
     const char *description;
 public:
     WebSocketError(const char *description) : description(description) { }
+    const char* getOcppOperationType() {
+        return "WebSocketError";
+    }
     const char *getErrorCode() {
         return "GenericError";
     }
@@ -3,6 +3,9 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/OcppMessage.h>
+#include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 
 #include <ArduinoOcpp/Debug.h>
 
@@ -11,6 +14,16 @@ using ArduinoOcpp::OcppMessage;
 OcppMessage::OcppMessage() {}
 
 OcppMessage::~OcppMessage() {}
+
+#ifndef AO_DEACTIVATE_POOLS
+void *OcppMessage::operator new(size_t size) {
+    return Pools::allocateObject(size);
+}
+
+void OcppMessage::operator delete(void *ptr) {
+    Pools::release(ptr);
+}
+#endif
   
 const char* OcppMessage::getOcppOperationType(){
     AO_DBG_ERR("Unsupported operation: getOcppOperationType() is not implemented");
@@ -24,6 +37,14 @@ void OcppMessage::setOcppModel(std::shared_ptr<OcppModel> ocppModel) {
     }
 }
 
+ArduinoOcpp::ConfigurationStore& OcppMessage::getConfigurationStore() {
+    if (ocppModel) {
+        return ocppModel->getConfigurationStore();
+    } else {
+        return *getDefaultConfigurationStore(); //message has not been assigned to an engine
+    }
+}
+
 void OcppMessage::initiate() {
     //called after initiateOcppOperation(anyMsg)
 }
@@ -26,16 +26,24 @@ namespace ArduinoOcpp {
 std::unique_ptr<DynamicJsonDocument> createEmptyDocument();
 
 class OcppModel;
+class ConfigurationStore;
 
 class OcppMessage {
 private:
     bool ocppModelInitialized = false;
 protected:
     std::shared_ptr<OcppModel> ocppModel;
+
+    ConfigurationStore& getConfigurationStore(); //store of the charge point which this message belongs to
 public:
     OcppMessage();
 
     virtual ~OcppMessage();
+
+#ifndef AO_DEACTIVATE_POOLS
+    static void *operator new(size_t size); //see ObjectPool.h
+    static void operator delete(void *ptr);
+#endif
     
     virtual const char* getOcppOperationType();
 
@@ -43,6 +51,14 @@ public:
 
     virtual void initiate();
 
+    /**
+     * Outgoing requests of the same sequence channel are executed strictly one after another, even if the
+     * OcppConnection pipelines several requests at once. For example, StartTransaction, MeterValues and
+     * StopTransaction on the same connector must reach the central system in their original order. Return
+     * the connectorId for such messages, or -1 if the message can be sent out of order.
+     */
+    virtual int getSequenceChannel() {return -1;}
+
     /**
      * Create the payload for the respective OCPP message
      * 
@@ -53,6 +69,31 @@ public:
      */
     virtual std::unique_ptr<DynamicJsonDocument> createReq();
 
+    /**
+     * If the build flag AO_FREEZE_REQUESTS is set, the engine calls createReq() only once and resends the same frame on
+     * retries. Messages whose payload depends on state which can change between two attempts (e.g. the transactionId
+     * which is assigned by the central system later) must return false here.
+     */
+    virtual bool canFreezeReq() {return true;}
+
+    /**
+     * Incoming requests are only deserialized completely if the message reads the payload. Messages which only
+     * answer with a CALLERROR (e.g. NotImplemented) return false, so that the payload is dropped without parsing.
+     */
+    virtual bool needsReqPayload() {return true;}
+
+    /**
+     * Approximate heap usage of this message, including the data it keeps for createReq(). The engine accounts
+     * queued operations with it. The default covers messages with a few scalar fields
+     */
+    virtual size_t getMemoryUsage() {return 64;}
+
+    /**
+     * If the queue of initiated operations exceeds its memory budget, the engine discards the oldest operations
+     * which haven't been sent yet. Messages which must not get lost (e.g. transaction events) return false
+     */
+    virtual bool isDroppable() {return true;}
+
 
     virtual void processConf(JsonObject payload);
     
@@ -10,12 +10,15 @@
 #include <ArduinoOcpp/Tasks/Diagnostics/DiagnosticsService.h>
 #include <ArduinoOcpp/Tasks/Heartbeat/HeartbeatService.h>
 
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <algorithm>
+
 using namespace ArduinoOcpp;
 
-OcppModel::OcppModel(const OcppClock& system_clock)
-        : ocppTime{system_clock} {
+OcppModel::OcppModel(const OcppClock& system_clock, std::shared_ptr<ConfigurationStore> configurationStore)
+        : ocppTime{system_clock}, configurationStore{configurationStore} {
     
 }
 
@@ -41,6 +44,30 @@ void OcppModel::loop() {
         firmwareService->loop();
 }
 
+unsigned long OcppModel::nextWakeupMs() {
+    unsigned long wakeup = AO_WAKEUP_NEVER;
+
+    if (chargePointStatusService)
+        wakeup = std::min(wakeup, chargePointStatusService->nextWakeupMs());
+    
+    if (smartChargingService)
+        wakeup = std::min(wakeup, smartChargingService->nextWakeupMs());
+    
+    if (heartbeatService)
+        wakeup = std::min(wakeup, heartbeatService->nextWakeupMs());
+    
+    if (meteringService)
+        wakeup = std::min(wakeup, meteringService->nextWakeupMs());
+    
+    if (diagnosticsService)
+        wakeup = std::min(wakeup, diagnosticsService->nextWakeupMs());
+    
+    if (firmwareService)
+        wakeup = std::min(wakeup, firmwareService->nextWakeupMs());
+
+    return wakeup;
+}
+
 void OcppModel::setSmartChargingService(std::unique_ptr<SmartChargingService> scs) {
     smartChargingService = std::move(scs);
 }
@@ -99,3 +126,7 @@ void OcppModel::setHeartbeatService(std::unique_ptr<HeartbeatService> hs) {
 OcppTime& OcppModel::getOcppTime() {
     return ocppTime;
 }
+
+ConfigurationStore &OcppModel::getConfigurationStore() {
+    return *configurationStore;
+}
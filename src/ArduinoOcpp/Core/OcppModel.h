@@ -18,6 +18,7 @@ class MeteringService;
 class FirmwareService;
 class DiagnosticsService;
 class HeartbeatService;
+class ConfigurationStore;
 
 class OcppModel {
 private:
@@ -28,15 +29,18 @@ private:
     std::unique_ptr<DiagnosticsService> diagnosticsService;
     std::unique_ptr<HeartbeatService> heartbeatService;
     OcppTime ocppTime;
+    std::shared_ptr<ConfigurationStore> configurationStore;
 
 public:
-    OcppModel(const OcppClock& system_clock);
+    OcppModel(const OcppClock& system_clock, std::shared_ptr<ConfigurationStore> configurationStore);
     OcppModel() = delete;
     OcppModel(const OcppModel& rhs) = delete;
     ~OcppModel();
 
     void loop();
 
+    unsigned long nextWakeupMs(); //time until the next timer of the services expires
+
     void setSmartChargingService(std::unique_ptr<SmartChargingService> scs);
     SmartChargingService* getSmartChargingService() const;
 
@@ -56,6 +60,8 @@ public:
     void setHeartbeatService(std::unique_ptr<HeartbeatService> heartbeatService);
 
     OcppTime &getOcppTime();
+
+    ConfigurationStore &getConfigurationStore(); //the configurations of this charge point
 };
 
 } //end namespace ArduinoOcpp
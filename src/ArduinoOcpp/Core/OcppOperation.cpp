@@ -6,14 +6,98 @@
 #include <ArduinoOcpp/Core/OcppMessage.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Core/HeapProfile.h>
+#include <ArduinoOcpp/Core/OperationMetrics.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 
 #include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
-int unique_id_counter = 1000000;
+#include <string.h>
 
 using namespace ArduinoOcpp;
 
+/*
+ * Serializes an OCPP-J frame directly into the send buffer of the socket. The frame is the RPC header array
+ * with the payload as its last element. The header is serialized first, then its closing bracket is replaced
+ * by a comma, followed by the payload and a new closing bracket
+ */
+static bool sendFrame(OcppSocket& ocppSocket, const JsonDocument& header, const JsonDocument& payload, std::string *frameCopy = nullptr) {
+    size_t headerLen = measureJson(header);
+    size_t payloadLen = measureJson(payload);
+    size_t frameLen = headerLen + payloadLen + 1; //header without ']', ',', payload, ']'
+
+    char *frame = ocppSocket.reserveTXT(frameLen + 1); //+1 for the terminating zero
+    if (!frame) {
+        AO_DBG_ERR("Cannot reserve frame buffer");
+        return false;
+    }
+
+    serializeJson(header, frame, headerLen + 1);
+    frame[headerLen - 1] = ',';
+    serializeJson(payload, frame + headerLen, payloadLen + 1);
+    frame[frameLen - 1] = ']';
+    frame[frameLen] = '\0';
+
+    AO_DBG_TRAFFIC_OUT(frame); //print before sending: the WebSocket client masks the frame in place
+
+    if (frameCopy) {
+        frameCopy->assign(frame, frameLen);
+    }
+
+    return ocppSocket.commitTXT(frameLen);
+}
+
+/*
+ * MessagePack counterpart of sendFrame(). The header is serialized as fixarray (first byte 0x90 | n) with at most
+ * four elements. Incrementing the first byte makes room for the payload, which is appended as last element
+ */
+static bool sendFrameMsgPack(OcppSocket& ocppSocket, const JsonDocument& header, const JsonDocument& payload, std::string *frameCopy = nullptr) {
+    size_t headerLen = measureMsgPack(header);
+    size_t payloadLen = measureMsgPack(payload);
+    size_t frameLen = headerLen + payloadLen;
+
+    char *frame = ocppSocket.reserveTXT(frameLen + 1);
+    if (!frame) {
+        AO_DBG_ERR("Cannot reserve frame buffer");
+        return false;
+    }
+
+    serializeMsgPack(header, frame, headerLen + 1);
+    frame[0] = (char) ((uint8_t) frame[0] + 1);
+    serializeMsgPack(payload, frame + headerLen, payloadLen + 1);
+
+    AO_DBG_TRAFFIC_OUT("MessagePack frame");
+
+    if (frameCopy) {
+        frameCopy->assign(frame, frameLen);
+    }
+
+    return ocppSocket.commitBIN(frameLen);
+}
+
+/*
+ * Sends a frame which has been serialized before
+ */
+static bool resendFrame(OcppSocket& ocppSocket, const std::string& frameCopy, bool binary) {
+    char *frame = ocppSocket.reserveTXT(frameCopy.length() + 1);
+    if (!frame) {
+        AO_DBG_ERR("Cannot reserve frame buffer");
+        return false;
+    }
+
+    memcpy(frame, frameCopy.c_str(), frameCopy.length() + 1);
+
+    if (binary) {
+        AO_DBG_TRAFFIC_OUT("MessagePack frame");
+        return ocppSocket.commitBIN(frameCopy.length());
+    }
+
+    AO_DBG_TRAFFIC_OUT(frame);
+
+    return ocppSocket.commitTXT(frameCopy.length());
+}
+
 OcppOperation::OcppOperation(std::unique_ptr<OcppMessage> msg) : ocppMessage(std::move(msg)) {
 
 }
@@ -26,8 +110,33 @@ OcppOperation::~OcppOperation(){
 
 }
 
-void OcppOperation::setOcppMessage(std::unique_ptr<OcppMessage> msg){
+#ifndef AO_DEACTIVATE_POOLS
+void *OcppOperation::operator new(size_t size) {
+    return Pools::allocateOperation(size);
+}
+
+void OcppOperation::operator delete(void *ptr) {
+    Pools::release(ptr);
+}
+#endif
+
+void OcppOperation::setOcppMessage(std::unique_ptr<OcppMessage> msg, OcppAction action){
     ocppMessage = std::move(msg);
+    this->action = action;
+}
+
+void OcppOperation::setBinaryFraming(bool binary) {
+    if (binary != binaryFraming) {
+        frozenReq.clear(); //create the request again in the new framing
+    }
+    binaryFraming = binary;
+}
+
+OcppAction OcppOperation::getOcppAction() {
+    if (action == OcppAction::Unknown && ocppMessage) {
+        action = ArduinoOcpp::getOcppAction(ocppMessage->getOcppOperationType()); //lookup only. Custom actions are registered by OcppOperationFactory
+    }
+    return action;
 }
 
 void OcppOperation::setOcppModel(std::shared_ptr<OcppModel> oModel) {
@@ -48,8 +157,6 @@ void OcppOperation::setTimeout(std::unique_ptr<Timeout> to){
         return;
     }
     timeout = std::move(to);
-    timeout->setOnTimeoutListener(onTimeoutListener);
-    timeout->setOnAbortListener(onAbortListener);
 }
 
 Timeout *OcppOperation::getTimeout() {
@@ -64,12 +171,6 @@ void OcppOperation::setMessageID(const std::string &id){
 }
 
 const std::string *OcppOperation::getMessageID() {
-    if (messageID.empty()) {
-        char id_str [16] = {'\0'};
-        sprintf(id_str, "%d", unique_id_counter++);
-        messageID = std::string {id_str};
-        //messageID = std::to_string(unique_id_counter++);
-    }
     return &messageID;
 }
 
@@ -83,9 +184,12 @@ boolean OcppOperation::sendReq(OcppSocket& ocppSocket){
     if (timeout->isExceeded()) {
         //cancel this operation
         AO_DBG_INFO("%s has timed out! Discard operation", ocppMessage->getOcppOperationType());
+        notifyTimeout();
         return true;
     }
 
+    reqStarted = true;
+
     /*
      * retry behaviour
      * 
@@ -99,53 +203,77 @@ boolean OcppOperation::sendReq(OcppSocket& ocppSocket){
     if (RETRY_INTERVAL * retry_interval_mult * 2 <= RETRY_INTERVAL_MAX)
         retry_interval_mult *= 2;
 
-    /*
-     * Create the OCPP message
-     */
-    auto requestPayload = ocppMessage->createReq();
-    if (!requestPayload) {
-        onAbortListener();
-        return true;
-    }
+    bool success = false;
 
-    /*
-     * Create OCPP-J Remote Procedure Call header
-     */
-    size_t json_buffsize = JSON_ARRAY_SIZE(4) + (getMessageID()->length() + 1) + requestPayload->capacity();
-    DynamicJsonDocument requestJson(json_buffsize);
+    if (!frozenReq.empty()) {
+        /*
+         * The request has been serialized on the first attempt already. Send the same frame again
+         */
+        success = resendFrame(ocppSocket, frozenReq, binaryFraming);
+    } else {
+        /*
+         * Create the OCPP message
+         */
+        auto requestPayload = ocppMessage->createReq();
+        if (!requestPayload) {
+            notifyAbort();
+            return true;
+        }
+        AO_HEAP_RECORD(getOcppAction(), CreateReq, requestPayload->capacity());
 
-    requestJson.add(MESSAGE_TYPE_CALL);                    //MessageType
-    requestJson.add(*getMessageID());                      //Unique message ID
-    requestJson.add(ocppMessage->getOcppOperationType());  //Action
-    requestJson.add(*requestPayload);                      //Payload
+        /*
+         * Create OCPP-J Remote Procedure Call header
+         */
+        StaticJsonDocument<JSON_ARRAY_SIZE(3)> requestHeader;
+
+        requestHeader.add(MESSAGE_TYPE_CALL);                    //MessageType
+        requestHeader.add(getMessageID()->c_str());              //Unique message ID
+        requestHeader.add(ocppMessage->getOcppOperationType());  //Action
+
+        std::string *freezeReq = nullptr;
+#ifdef AO_FREEZE_REQUESTS
+        if (ocppMessage->canFreezeReq()) {
+            freezeReq = &frozenReq;
+        }
+#endif
+
+        /*
+         * Serialize header and payload directly into the send buffer of the socket and send.
+         */
+        if (binaryFraming) {
+            AO_HEAP_RECORD(getOcppAction(), SendReq, measureMsgPack(requestHeader) + measureMsgPack(*requestPayload) + 1);
+            success = sendFrameMsgPack(ocppSocket, requestHeader, *requestPayload, freezeReq);
+        } else {
+            AO_HEAP_RECORD(getOcppAction(), SendReq, measureJson(requestHeader) + measureJson(*requestPayload) + 1);
+            success = sendFrame(ocppSocket, requestHeader, *requestPayload, freezeReq);
+        }
+    }
 
     /*
-     * Serialize and send. Destroy serialization and JSON object. 
-     * 
      * If sending was successful, start timer
      * 
      * Return that this function must be called again (-> false)
      */
-    std::string out {};
-    serializeJson(requestJson, out);
-
-    if (printReqCounter > 5000) {
-        printReqCounter = 0;
-        AO_DBG_DEBUG("Try to send request: %s", out.c_str());
-    }
-    printReqCounter++;
-    
-    bool success = ocppSocket.sendTXT(out);
-
     timeout->tick(success);
     
+    sendRefused = !success;
+
     if (success) {
-        AO_DBG_TRAFFIC_OUT(out.c_str());
         retry_start = ao_tick_ms();
+#ifdef AO_OPERATION_METRICS
+        if (sendCount == 0) {
+            AO_METRICS_RECORD(getOcppAction(), QueueWait, retry_start - initiatedTime);
+        } else {
+            AO_METRICS_RETRY(getOcppAction());
+        }
+        sendCount++;
+        lastSendTime = retry_start;
+#endif
     } else {
         //ocppSocket is not able to put any data on TCP stack. Maybe because we're offline
         retry_start = 0;
         retry_interval_mult = 1;
+        refusedTime = ao_tick_ms();
     }
 
     return false;
@@ -155,10 +283,18 @@ boolean OcppOperation::receiveConf(JsonDocument& confJson){
     /*
      * check if messageIDs match. If yes, continue with this function. If not, return false for message not consumed
      */
-    if (*getMessageID() != confJson[1].as<std::string>()){
+    const char *confId = confJson[1] | "";
+    if (strcmp(getMessageID()->c_str(), confId)){
         return false;
     }
 
+    AO_HEAP_RECORD(getOcppAction(), ReceiveConf, confJson.memoryUsage());
+#ifdef AO_OPERATION_METRICS
+    if (sendCount > 0) {
+        AO_METRICS_RECORD(getOcppAction(), Conf, ao_tick_ms() - lastSendTime);
+    }
+#endif
+
     /*
      * Hand the payload over to the OcppMessage object
      */
@@ -168,7 +304,9 @@ boolean OcppOperation::receiveConf(JsonDocument& confJson){
     /*
      * Hand the payload over to the onReceiveConf Callback
      */
-    onReceiveConfListener(payload);
+    if (listeners && listeners->onReceiveConf) {
+        listeners->onReceiveConf(payload);
+    }
 
     /*
      * return true as this message has been consumed
@@ -180,10 +318,18 @@ boolean OcppOperation::receiveError(JsonDocument& confJson){
     /*
      * check if messageIDs match. If yes, continue with this function. If not, return false for message not consumed
      */
-    if (*getMessageID() != confJson[1].as<std::string>()){
+    const char *confId = confJson[1] | "";
+    if (strcmp(getMessageID()->c_str(), confId)){
         return false;
     }
 
+    AO_HEAP_RECORD(getOcppAction(), ReceiveConf, confJson.memoryUsage());
+#ifdef AO_OPERATION_METRICS
+    if (sendCount > 0) {
+        AO_METRICS_RECORD(getOcppAction(), Error, ao_tick_ms() - lastSendTime);
+    }
+#endif
+
     /*
      * Hand the error over to the OcppMessage object
      */
@@ -193,13 +339,18 @@ boolean OcppOperation::receiveError(JsonDocument& confJson){
     bool abortOperation = ocppMessage->processErr(errorCode, errorDescription, errorDetails);
 
     if (abortOperation) {
-        onReceiveErrorListener(errorCode, errorDescription, errorDetails);
-        onAbortListener();
+        if (listeners && listeners->onReceiveError) {
+            listeners->onReceiveError(errorCode, errorDescription, errorDetails);
+        }
+        notifyAbort();
     } else {
         //restart operation
         timeout->restart();
         retry_start = 0;
         retry_interval_mult = 1;
+        sendRefused = false; //send again immediately
+        frozenReq.clear(); //create the request again
+        frozenReq.shrink_to_fit();
     }
 
     return abortOperation;
@@ -210,19 +361,22 @@ boolean OcppOperation::receiveReq(JsonDocument& reqJson){
     std::string reqId = reqJson[1];
     setMessageID(reqId);
 
-    //TODO What if client receives requests two times? Can happen if previous conf is lost. In the Smart Charging Profile
-    //     it probably doesn't matter to repeat an operation on the EVSE. Change in future?
-    
+    //Requests which the server repeats because it lost the conf are filtered by the OcppConnection (see confCache)
+
     /*
      * Hand the payload over to the OcppOperation object
      */
+    AO_HEAP_RECORD(getOcppAction(), ReceiveReq, reqJson.memoryUsage());
+
     JsonObject payload = reqJson[3];
     ocppMessage->processReq(payload);
     
     /*
      * Hand the payload over to the first Callback. It is a callback that notifies the client that request has been processed in the OCPP-library
      */
-    onReceiveReqListener(payload);
+    if (listeners && listeners->onReceiveReq) {
+        listeners->onReceiveReq(payload);
+    }
 
     reqExecuted = true; //ensure that the conf is only sent after the req has been executed
 
@@ -236,76 +390,106 @@ boolean OcppOperation::sendConf(OcppSocket& ocppSocket){
         return false;
     }
 
-    /*
-     * Create the OCPP message
-     */
-    std::unique_ptr<DynamicJsonDocument> confJson = nullptr;
-    std::unique_ptr<DynamicJsonDocument> confPayload = std::unique_ptr<DynamicJsonDocument>(ocppMessage->createConf());
-    std::unique_ptr<DynamicJsonDocument> errorDetails = nullptr;
-    
-    bool operationSuccess = ocppMessage->getErrorCode() == nullptr && confPayload != nullptr;
-
-    if (operationSuccess) {
+    boolean wsSuccess = false;
 
+    if (!confFrame.empty()) {
         /*
-         * Create OCPP-J Remote Procedure Call header
+         * A previous attempt to send the conf failed. Send the same frame again
          */
-        size_t json_buffsize = JSON_ARRAY_SIZE(3) + (getMessageID()->length() + 1) + confPayload->capacity();
-        confJson = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(json_buffsize));
-
-        confJson->add(MESSAGE_TYPE_CALLRESULT);   //MessageType
-        confJson->add(*getMessageID());            //Unique message ID
-        confJson->add(*confPayload);              //Payload
+        wsSuccess = resendFrame(ocppSocket, confFrame, binaryFraming);
     } else {
-        //operation failure. Send error message instead
-
-        const char *errorCode = ocppMessage->getErrorCode();
-        const char *errorDescription = ocppMessage->getErrorDescription();
-        errorDetails = std::unique_ptr<DynamicJsonDocument>(ocppMessage->getErrorDetails());
-        if (!errorCode) { //catch corner case when payload is null but errorCode is not set too!
-            errorCode = "GenericError";
-            errorDescription = "Could not create payload (createConf() returns Null)";
-            errorDetails = std::unique_ptr<DynamicJsonDocument>(createEmptyDocument());
-        }
-
         /*
-         * Create OCPP-J Remote Procedure Call header
+         * Create the OCPP message
          */
-        size_t json_buffsize = JSON_ARRAY_SIZE(5)
-                    + (getMessageID()->length() + 1)
-                    + strlen(errorCode) + 1
-                    + strlen(errorDescription) + 1
-                    + errorDetails->capacity();
-        confJson = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(json_buffsize));
+        confPayload = std::unique_ptr<DynamicJsonDocument>(ocppMessage->createConf());
+        std::unique_ptr<DynamicJsonDocument> errorDetails = nullptr;
 
-        confJson->add(MESSAGE_TYPE_CALLERROR);   //MessageType
-        confJson->add(*getMessageID());            //Unique message ID
-        confJson->add(errorCode);
-        confJson->add(errorDescription);
-        confJson->add(*errorDetails);              //Error description
-    }
+        confSuccess = ocppMessage->getErrorCode() == nullptr && confPayload != nullptr;
+        if (confPayload) {
+            AO_HEAP_RECORD(getOcppAction(), CreateConf, confPayload->capacity());
+        }
 
-    /*
-     * Serialize and send. Destroy serialization and JSON object. 
-     */
-    std::string out {};
-    serializeJson(*confJson, out);
-    boolean wsSuccess = ocppSocket.sendTXT(out);
+        if (confSuccess) {
+
+            /*
+             * Create OCPP-J Remote Procedure Call header
+             */
+            StaticJsonDocument<JSON_ARRAY_SIZE(2)> confHeader;
+
+            confHeader.add(MESSAGE_TYPE_CALLRESULT);   //MessageType
+            confHeader.add(getMessageID()->c_str());   //Unique message ID
+
+            if (binaryFraming) {
+                wsSuccess = sendFrameMsgPack(ocppSocket, confHeader, *confPayload, &confFrame);
+            } else {
+                wsSuccess = sendFrame(ocppSocket, confHeader, *confPayload, &confFrame);
+            }
+            AO_HEAP_RECORD(getOcppAction(), SendConf, confFrame.capacity());
+        } else {
+            //operation failure. Send error message instead
+
+            const char *errorCode = ocppMessage->getErrorCode();
+            const char *errorDescription = ocppMessage->getErrorDescription();
+            errorDetails = std::unique_ptr<DynamicJsonDocument>(ocppMessage->getErrorDetails());
+            if (!errorCode) { //catch corner case when payload is null but errorCode is not set too!
+                errorCode = "GenericError";
+                errorDescription = "Could not create payload (createConf() returns Null)";
+                errorDetails = std::unique_ptr<DynamicJsonDocument>(createEmptyDocument());
+            }
+
+            AO_DBG_WARN("Operation failed. Send CallError %s: %s", errorCode, errorDescription);
+
+            /*
+             * Create OCPP-J Remote Procedure Call header
+             */
+            StaticJsonDocument<JSON_ARRAY_SIZE(4)> errorHeader;
+
+            errorHeader.add(MESSAGE_TYPE_CALLERROR);   //MessageType
+            errorHeader.add(getMessageID()->c_str());  //Unique message ID
+            errorHeader.add(errorCode);
+            errorHeader.add(errorDescription);
+
+            AO_HEAP_RECORD(getOcppAction(), CreateConf, errorDetails->capacity());
+            if (binaryFraming) {
+                wsSuccess = sendFrameMsgPack(ocppSocket, errorHeader, *errorDetails, &confFrame); //Error details
+            } else {
+                wsSuccess = sendFrame(ocppSocket, errorHeader, *errorDetails, &confFrame); //Error details
+            }
+            AO_HEAP_RECORD(getOcppAction(), SendConf, confFrame.capacity());
+        }
+    }
 
     if (wsSuccess) {
-        if (operationSuccess) {
-            AO_DBG_TRAFFIC_OUT(out.c_str());
-            onSendConfListener(confPayload->as<JsonObject>());
+        if (confSuccess) {
+            if (listeners && listeners->onSendConf) {
+                listeners->onSendConf(confPayload->as<JsonObject>());
+            }
         } else {
-            AO_DBG_WARN("Operation failed. JSON CallError message: %s", out.c_str());
-            onAbortListener();
+            notifyAbort();
         }
+        confPayload.reset();
     }
 
     return wsSuccess;
 }
 
-void OcppOperation::setInitiated() {
+bool OcppOperation::releaseConfFrame(std::string& out) {
+    if (!confSuccess || confFrame.empty()) {
+        return false;
+    }
+    out = std::move(confFrame);
+    confFrame.clear();
+    return true;
+}
+
+void OcppOperation::setInitiated(int msgIdNum) {
+    char id_str [16] = {'\0'};
+    sprintf(id_str, "%d", msgIdNum);
+    setMessageID(id_str);
+    messageIdNum = msgIdNum;
+#ifdef AO_OPERATION_METRICS
+    initiatedTime = ao_tick_ms();
+#endif
     if (ocppMessage) {
         ocppMessage->initiate();
     } else {
@@ -315,7 +499,7 @@ void OcppOperation::setInitiated() {
 
 void OcppOperation::setOnReceiveConfListener(OnReceiveConfListener onReceiveConf){
     if (onReceiveConf)
-        onReceiveConfListener = onReceiveConf;
+        editListeners().onReceiveConf = onReceiveConf;
 }
 
 /**
@@ -323,27 +507,119 @@ void OcppOperation::setOnReceiveConfListener(OnReceiveConfListener onReceiveConf
  */
 void OcppOperation::setOnReceiveReqListener(OnReceiveReqListener onReceiveReq){
     if (onReceiveReq)
-        onReceiveReqListener = onReceiveReq;
+        editListeners().onReceiveReq = onReceiveReq;
 }
 
 void OcppOperation::setOnSendConfListener(OnSendConfListener onSendConf){
     if (onSendConf)
-        onSendConfListener = onSendConf;
+        editListeners().onSendConf = onSendConf;
 }
 
 void OcppOperation::setOnTimeoutListener(OnTimeoutListener onTimeout) {
     if (onTimeout)
-        onTimeoutListener = onTimeout;
+        editListeners().onTimeout = onTimeout;
 }
 
 void OcppOperation::setOnReceiveErrorListener(OnReceiveErrorListener onReceiveError) {
     if (onReceiveError)
-        onReceiveErrorListener = onReceiveError;
+        editListeners().onReceiveError = onReceiveError;
 }
 
 void OcppOperation::setOnAbortListener(OnAbortListener onAbort) {
     if (onAbort)
-        onAbortListener = onAbort;
+        editListeners().onAbort = onAbort;
+}
+
+void OcppOperation::setListeners(std::shared_ptr<OperationListeners> listeners) {
+    this->listeners = listeners;
+}
+
+OperationListeners& OcppOperation::editListeners() {
+    if (!listeners) {
+        listeners = std::make_shared<OperationListeners>();
+    } else if (!listeners.unique()) {
+        listeners = std::make_shared<OperationListeners>(*listeners); //the set is shared. Don't modify the other operations
+    }
+    return *listeners;
+}
+
+bool OcppOperation::getNextDue(ulong &due) {
+    bool hasDue = timeout->getDeadline(due);
+
+    if (reqStarted) {
+        ulong retryDue = retry_start + RETRY_INTERVAL * retry_interval_mult + 1; //see retry condition in sendReq()
+        if (retry_start == 0) {
+            if (sendRefused) {
+                retryDue = refusedTime + RETRY_INTERVAL; //socket was offline. Don't poll it in every loop
+            } else {
+                retryDue = ao_tick_ms(); //not sent yet or restarted. Try immediately
+            }
+        }
+        if (!hasDue || (long) (retryDue - due) < 0) {
+            due = retryDue;
+            hasDue = true;
+        }
+    }
+
+    return hasDue;
+}
+
+int OcppOperation::getSequenceChannel() {
+    if (ocppMessage) {
+        return ocppMessage->getSequenceChannel();
+    } else {
+        return -1;
+    }
+}
+
+bool OcppOperation::needsReqPayload() {
+    if (ocppMessage) {
+        return ocppMessage->needsReqPayload();
+    } else {
+        return false;
+    }
+}
+
+size_t OcppOperation::getMemoryUsage() {
+    size_t usage = sizeof(OcppOperation) + sizeof(*timeout);
+    usage += messageID.capacity() + frozenReq.capacity() + confFrame.capacity();
+    if (confPayload) {
+        usage += confPayload->capacity();
+    }
+    if (ocppMessage) {
+        usage += ocppMessage->getMemoryUsage();
+    }
+    return usage;
+}
+
+bool OcppOperation::isDroppable() {
+    return !reqStarted && ocppMessage && ocppMessage->isDroppable();
+}
+
+void OcppOperation::drop() {
+    AO_DBG_WARN("Drop %s operation (memory budget exceeded)", ocppMessage ? ocppMessage->getOcppOperationType() : "unknown");
+    notifyAbort();
+}
+
+void OcppOperation::notifyAbort() {
+    if (listeners && listeners->onAbort) {
+        listeners->onAbort();
+    }
+}
+
+void OcppOperation::notifyTimeout() {
+#ifdef AO_OPERATION_METRICS
+    if (ocppMessage) {
+        AO_METRICS_RECORD(getOcppAction(), Timeout, ao_tick_ms() - initiatedTime);
+    }
+#endif
+    if (listeners && listeners->onTimeout) {
+        listeners->onTimeout();
+    }
+    notifyAbort();
+    if (timeout) {
+        timeout->notifyListeners();
+    }
 }
 
 boolean OcppOperation::isFullyConfigured(){
@@ -10,8 +10,11 @@
 #define MESSAGE_TYPE_CALLERROR 4
 
 #include <memory>
+#include <string>
 
 #include <ArduinoOcpp/Core/OcppOperationCallbacks.h>
+#include <ArduinoOcpp/Core/OcppAction.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -22,16 +25,15 @@ class OcppSocket;
 class OcppOperation {
 private:
     std::string messageID {};
+    int messageIdNum = -1; //numeric form of messageID for initiated operations; -1 if not assigned yet
     std::unique_ptr<OcppMessage> ocppMessage;
-    const std::string *getMessageID();
+    OcppAction action = OcppAction::Unknown; //interned operation type of ocppMessage. Resolved on first use if Unknown
     void setMessageID(const std::string &id);
-    OnReceiveConfListener onReceiveConfListener = [] (JsonObject payload) {};
-    OnReceiveReqListener onReceiveReqListener = [] (JsonObject payload) {};
-    OnSendConfListener onSendConfListener = [] (JsonObject payload) {};
-    OnTimeoutListener onTimeoutListener = [] () {};
-    OnReceiveErrorListener onReceiveErrorListener = [] (const char *code, const char *description, JsonObject details) {};
-    OnAbortListener onAbortListener = [] () {};
+    std::shared_ptr<OperationListeners> listeners; //shared with other operations, copied on write. nullptr if no listeners
+    OperationListeners& editListeners();
+    void notifyAbort();
     boolean reqExecuted = false;
+    bool reqStarted = false; //true after the first call of sendReq(). From then on, the operation counts as in flight
 
     std::unique_ptr<Timeout> timeout{new OfflineSensitiveTimeout(40000)};
 
@@ -39,8 +41,24 @@ private:
     const ulong RETRY_INTERVAL_MAX = 20000; //in ms; 
     ulong retry_start = 0;
     ulong retry_interval_mult = 1; // RETRY_INTERVAL * retry_interval_mult gives longer periods with each iteration
+    bool sendRefused = false; //true if the socket refused the last attempt (e.g. offline)
+    ulong refusedTime = 0; //if sendRefused: time of the refused attempt
+
+    std::string frozenReq; //with AO_FREEZE_REQUESTS: the serialized request frame for resending on retries. Empty if not sent yet
+
+    std::string confFrame; //the serialized conf / CallError. Created once and sent again if the socket refuses it
+    std::unique_ptr<DynamicJsonDocument> confPayload; //kept until the conf is sent for the onSendConf listener
+    bool confSuccess = false; //true if confFrame is a CallResult, false if it is a CallError
+
+    size_t budgetedSize = 0;
+
+    bool binaryFraming = false; //send as MessagePack instead of JSON text. Fixed once the first frame is serialized
 
-    uint16_t printReqCounter = 0;
+#ifdef AO_OPERATION_METRICS
+    ulong initiatedTime = 0; //when the operation entered the queue
+    ulong lastSendTime = 0; //when the request was sent the last time
+    unsigned int sendCount = 0;
+#endif
 public:
 
     OcppOperation(std::unique_ptr<OcppMessage> msg);
@@ -49,7 +67,14 @@ public:
 
     ~OcppOperation();
 
-    void setOcppMessage(std::unique_ptr<OcppMessage> msg);
+#ifndef AO_DEACTIVATE_POOLS
+    static void *operator new(size_t size); //see ObjectPool.h
+    static void operator delete(void *ptr);
+#endif
+
+    void setOcppMessage(std::unique_ptr<OcppMessage> msg, OcppAction action = OcppAction::Unknown); //pass the action if it is known already
+
+    OcppAction getOcppAction(); //OcppAction::Unknown if the message type is neither standard nor registered in the factory
 
     void setOcppModel(std::shared_ptr<OcppModel> oModel);
 
@@ -98,7 +123,67 @@ public:
      */
     boolean sendConf(OcppSocket& ocppSocket);
 
-    void setInitiated();
+    /**
+     * After sendConf() has sent a CallResult successfully, this function moves the serialized frame into out. The
+     * OcppConnection keeps recent frames to answer repeated requests. Returns false if there is no CallResult frame
+     */
+    bool releaseConfFrame(std::string& out);
+
+    const std::string *getMessageID();
+
+    /*
+     * Marks this operation as initiated by this device with the numeric message ID msgIdNum. Each OcppConnection
+     * counts its own message IDs, so engines on separate threads don't share a counter
+     */
+    void setInitiated(int msgIdNum);
+
+    /**
+     * Numeric message ID of an initiated operation. The engine assigns it in setInitiated(), so that the
+     * OcppConnection can match incoming CALLRESULTs and CALLERRORs without string operations.
+     * 
+     * Returns -1 if this operation has not been initiated by this device
+     */
+    int getMessageIdNum() {return messageIdNum;}
+
+    bool isReqStarted() {return reqStarted;}
+
+    /*
+     * Selects MessagePack framing for the frames of this operation. The OcppConnection sets it before the first
+     * sendReq() or sendConf() call
+     */
+    void setBinaryFraming(bool binary); //drops a frozen request which has been serialized in the other framing
+    bool isBinaryFraming() {return binaryFraming;}
+
+    /**
+     * Determines when the engine must process this operation next, i.e. call sendReq() for the next (re)try or check
+     * the timeout. Returns false if the operation doesn't need to be processed until an incoming message concerns it
+     */
+    bool getNextDue(ulong &due);
+
+    int getSequenceChannel();
+
+    bool needsReqPayload();
+
+    size_t getMemoryUsage(); //approximate heap usage of this operation, including the serialized frames it keeps
+
+    /*
+     * The amount which the OcppConnection has accounted for this operation in its memory budget
+     */
+    void setBudgetedSize(size_t size) {budgetedSize = size;}
+    size_t getBudgetedSize() {return budgetedSize;}
+
+    bool isDroppable(); //if the operation hasn't been sent yet and its message may be discarded
+
+    /*
+     * Discards this operation because the memory budget is exceeded. Calls the onAbort listener
+     */
+    void drop();
+
+    /*
+     * Called by the OcppConnection if the operation times out before it could be sent. Timeouts of sent requests
+     * are detected by sendReq(). Calls the onTimeout and onAbort listeners
+     */
+    void notifyTimeout();
 
     void setOnReceiveConfListener(OnReceiveConfListener onReceiveConf);
 
@@ -121,11 +206,18 @@ public:
      *    - Cannot create OCPP payload
      *    - Timeout
      *    - Receives error msg instead of confirmation msg
+     *    - Dropped or rejected because the queue exceeds its memory budget
      * 
      * The engine uses this listener in both modes: EVSE mode and Central system mode
      */
     void setOnAbortListener(OnAbortListener onAbort);
 
+    /*
+     * Shares the given listener set with this operation instead of setting the listeners one by one. The set must
+     * not be modified afterwards. Listeners which are set on this operation later go into a private copy
+     */
+    void setListeners(std::shared_ptr<OperationListeners> listeners);
+
     boolean isFullyConfigured();
 
     void print_debug();
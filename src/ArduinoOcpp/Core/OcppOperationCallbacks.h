@@ -8,17 +8,43 @@
 #include <ArduinoJson.h>
 #include <functional>
 
+#include <ArduinoOcpp/Core/InlineCallback.h>
 #include <ArduinoOcpp/Core/OcppOperationTimeout.h>
 
 namespace ArduinoOcpp {
 
+/*
+ * The listener types of the public API. They are std::function, like before
+ */
 using OnReceiveConfListener = std::function<void(JsonObject payload)>;
 using OnReceiveReqListener = std::function<void(JsonObject payload)>;
 using OnSendConfListener = std::function<void(JsonObject payload)>;
-//using OnTimeoutListener = std::function<void()>; //in OcppOperationTimeout. Workaround for circle include. Fix by extracting type definitions to new source file
+//using OnTimeoutListener = std::function<void()>; //in OcppOperationTimeout.h
 using OnReceiveErrorListener = std::function<void(const char *code, const char *description, JsonObject details)>; //will be called if OCPP communication partner returns error code
-//using OnAbortListener = std::function<void()>; //will be called whenever the engine will stop trying to execute the operation normallythere is a timeout or error (onAbort = onTimeout || onReceiveError)
+//using OnAbortListener = std::function<void()>; //in OcppOperationTimeout.h. Will be called whenever the engine will stop trying to execute the operation normallythere is a timeout or error (onAbort = onTimeout || onReceiveError)
 
+/*
+ * The operations store their listeners as InlineCallback. The setters convert the std::function of the public API;
+ * a std::function always fits into the inline buffer
+ */
+using OnReceiveConfCallback = InlineCallback<void(JsonObject payload)>;
+using OnReceiveReqCallback = InlineCallback<void(JsonObject payload)>;
+using OnSendConfCallback = InlineCallback<void(JsonObject payload)>;
+using OnTimeoutCallback = InlineCallback<void()>;
+using OnReceiveErrorCallback = InlineCallback<void(const char *code, const char *description, JsonObject details)>;
+using OnAbortCallback = InlineCallback<void()>;
+
+static_assert(sizeof(OnReceiveErrorListener) <= AO_CALLBACK_CAPACITY && sizeof(OnTimeoutListener) <= AO_CALLBACK_CAPACITY,
+        "AO_CALLBACK_CAPACITY must hold a std::function");
+
+struct OperationListeners {
+    OnReceiveConfCallback onReceiveConf;
+    OnReceiveReqCallback onReceiveReq;
+    OnSendConfCallback onSendConf;
+    OnTimeoutCallback onTimeout;
+    OnReceiveErrorCallback onReceiveError;
+    OnAbortCallback onAbort;
+};
 
 } //end namespace ArduinoOcpp
 #endif
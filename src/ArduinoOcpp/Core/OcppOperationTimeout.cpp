@@ -3,39 +3,61 @@
 // MIT License
 
 #include <ArduinoOcpp/Core/OcppOperationTimeout.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
 #include <ArduinoOcpp/Platform.h>
 
 using namespace ArduinoOcpp;
 
+#ifndef AO_DEACTIVATE_POOLS
+void *Timeout::operator new(size_t size) {
+    return Pools::allocateObject(size);
+}
+
+void Timeout::operator delete(void *ptr) {
+    Pools::release(ptr);
+}
+#endif
+
 void Timeout::setOnTimeoutListener(OnTimeoutListener onTimeout) {
-    if (onTimeout)
-        onTimeoutListener = onTimeout;
+    if (!onTimeout)
+        return;
+    if (!deprecatedListeners)
+        deprecatedListeners.reset(new DeprecatedListeners());
+    deprecatedListeners->onTimeout = onTimeout;
 }
 
 void Timeout::setOnAbortListener(OnAbortListener onAbort) {
-    if (onAbort)
-        onAbortListener = onAbort;
+    if (!onAbort)
+        return;
+    if (!deprecatedListeners)
+        deprecatedListeners.reset(new DeprecatedListeners());
+    deprecatedListeners->onAbort = onAbort;
 }
 
-void Timeout::trigger() {
-    if (!triggered && timerIsExceeded()) {
-        triggered = true;
-        onTimeoutListener();
-        onAbortListener();
-    }
+void Timeout::notifyListeners() {
+    if (!deprecatedListeners)
+        return;
+    if (deprecatedListeners->onTimeout)
+        deprecatedListeners->onTimeout();
+    if (deprecatedListeners->onAbort)
+        deprecatedListeners->onAbort();
 }
+
 void Timeout::tick(bool sendingSuccessful) {
     timerTick(sendingSuccessful);
-    trigger();
 }
 void Timeout::restart() {
-    triggered = false;
     timerRestart();
 }
 bool Timeout::isExceeded() {
-    bool exceeded = timerIsExceeded();
-    trigger();
-    return exceeded;
+    return timerIsExceeded();
+}
+bool Timeout::getDeadline(ulong &deadline) {
+    return timerDeadline(deadline);
+}
+bool Timeout::timerDeadline(ulong &deadline) {
+    deadline = ao_tick_ms();
+    return true;
 }
 
 FixedTimeout::FixedTimeout(ulong TIMEOUT_DURATION) : TIMEOUT_DURATION(TIMEOUT_DURATION) { 
@@ -55,6 +77,14 @@ void FixedTimeout::timerRestart() {
 bool FixedTimeout::timerIsExceeded() {
     return timeout_active && ao_tick_ms() - timeout_start >= TIMEOUT_DURATION;
 }
+bool FixedTimeout::timerDeadline(ulong &deadline) {
+    if (!timeout_active) {
+        deadline = ao_tick_ms(); //must be ticked first
+    } else {
+        deadline = timeout_start + TIMEOUT_DURATION;
+    }
+    return true;
+}
 
 
 OfflineSensitiveTimeout::OfflineSensitiveTimeout(ulong TIMEOUT_DURATION) : TIMEOUT_DURATION(TIMEOUT_DURATION) { 
@@ -85,3 +115,11 @@ void OfflineSensitiveTimeout::timerRestart() {
 bool OfflineSensitiveTimeout::timerIsExceeded() {
     return timeout_active && ao_tick_ms() - timeout_start >= TIMEOUT_DURATION;
 }
+bool OfflineSensitiveTimeout::timerDeadline(ulong &deadline) {
+    if (!timeout_active) {
+        deadline = ao_tick_ms(); //must be ticked first
+    } else {
+        deadline = timeout_start + TIMEOUT_DURATION;
+    }
+    return true;
+}
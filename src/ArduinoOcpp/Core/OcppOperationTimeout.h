@@ -6,32 +6,59 @@
 #define OCPPOPERATIONTIMEOUT_H
 
 #include <functional>
+#include <memory>
 
 #include <sys/types.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
 using OnTimeoutListener = std::function<void()>;
 using OnAbortListener = std::function<void()>;
 
+/*
+ * The OcppOperation checks isExceeded() and calls its onTimeout and onAbort listeners (see
+ * OcppOperation::notifyTimeout())
+ */
 class Timeout {
 private:
-    OnTimeoutListener onTimeoutListener = [] () {};
-    OnAbortListener onAbortListener = [] () {};
-    bool triggered = false;
-    void trigger();
+    struct DeprecatedListeners {
+        OnTimeoutListener onTimeout;
+        OnAbortListener onAbort;
+    };
+    std::unique_ptr<DeprecatedListeners> deprecatedListeners; //only allocated by the deprecated setters
 protected:
     Timeout() = default;
 public:
-    void setOnTimeoutListener(OnTimeoutListener onTimeoutListener);
-    void setOnAbortListener(OnAbortListener onAbortListener);
     virtual ~Timeout() = default;
+
+    /*
+     * Deprecated: set the listeners on the OcppOperation instead. The Timeout keeps them until it expires and the
+     * operation forwards the expiry via notifyListeners(), in addition to its own onTimeout and onAbort listeners
+     */
+    void setOnTimeoutListener(OnTimeoutListener onTimeout);
+    void setOnAbortListener(OnAbortListener onAbort);
+    void notifyListeners(); //called by OcppOperation::notifyTimeout()
+
+#ifndef AO_DEACTIVATE_POOLS
+    static void *operator new(size_t size); //see ObjectPool.h
+    static void operator delete(void *ptr);
+#endif
     void tick(bool sendingSuccessful);
     virtual void timerTick(bool sendingSuccessful) = 0;
     void restart();
     virtual void timerRestart() = 0;
     bool isExceeded();
     virtual bool timerIsExceeded() = 0;
+
+    /*
+     * Determines the point in time (ao_tick_ms() based) at which the timeout can expire at the earliest, assuming
+     * that it is not ticked or restarted in between. The engine doesn't check the timeout before that point. Returns
+     * false if the timeout can never expire. The default implementation returns the current time, i.e. the timeout
+     * is checked in each loop.
+     */
+    bool getDeadline(ulong &deadline);
+    virtual bool timerDeadline(ulong &deadline);
 };
 
 class FixedTimeout : public Timeout {
@@ -44,6 +71,7 @@ public:
     void timerTick(bool sendingSuccessful);
     void timerRestart();
     bool timerIsExceeded();
+    bool timerDeadline(ulong &deadline);
 };
 
 class OfflineSensitiveTimeout : public Timeout {
@@ -57,6 +85,7 @@ public:
     void timerTick(bool sendingSuccessful);
     void timerRestart();
     bool timerIsExceeded();
+    bool timerDeadline(ulong &deadline); //if offline, the engine ticks the timeout at the deadline which postpones it
 };
 
 class SuppressedTimeout : public Timeout {
@@ -65,6 +94,7 @@ public:
     void timerTick(bool sendingSuccessful) {}
     void timerRestart() {}
     bool timerIsExceeded() {return false;}
+    bool timerDeadline(ulong &deadline) {return false;}
 };
 
 } //end namespace ArduinoOcpp
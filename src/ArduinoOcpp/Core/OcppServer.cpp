@@ -17,6 +17,29 @@
 
 using namespace ArduinoOcpp::EspWiFi;
 
+namespace {
+
+/*
+ * The charge point identity is the last segment of the URL path, e.g. "/ocpp/CP001" -> "CP001". Returns an empty
+ * string if the path doesn't contain an identity
+ */
+std::string identityFromUrl(const char *url, size_t len) {
+    size_t end = 0;
+    while (end < len && url[end] != '?' && url[end] != '\0') {
+        end++;
+    }
+    while (end > 0 && url[end - 1] == '/') {
+        end--;
+    }
+    size_t begin = end;
+    while (begin > 0 && url[begin - 1] != '/') {
+        begin--;
+    }
+    return std::string(url + begin, end - begin);
+}
+
+} //end anonymous namespace
+
 OcppServer::OcppServer() {
     AO_DBG_WARN("OCPP Server only suitable for tests at the moment");
     wsockServer.begin();
@@ -33,7 +56,8 @@ void OcppServer::wsockEvent(WsClient num, WStype_t type, uint8_t * payload, size
         case WStype_DISCONNECTED:
             {
                 if (DEBUG_OUT) Serial.print(F("[OcppServer] WsClient disconnected! num = "));
-                if (DEBUG_OUT) Serial.println(num);                
+                if (DEBUG_OUT) Serial.println(num);
+                disconnectClient(num);
             }
             break;
         case WStype_CONNECTED:
@@ -48,44 +72,47 @@ void OcppServer::wsockEvent(WsClient num, WStype_t type, uint8_t * payload, size
                     Serial.println((const char*) payload);
                 }
 
-                bool found = false;
-				for (auto route = receiveTXTrouting.begin(); route != receiveTXTrouting.end(); ++route) {
-                    if (ip == (*route).ip_addr) {
-                        if (DEBUG_OUT) Serial.print(F("[OcppServer] IPAddress matches existing route!\n"));
-                        (*route).num = num;
-                        found = true;
-                        break;
-                    }
+                std::string cpIdentity = identityFromUrl((const char*) payload, length);
+
+                ReceiveTXTroute *route = nullptr;
+                if (!cpIdentity.empty()) {
+                    route = findRoute(cpIdentity);
+                }
+                if (!route) {
+                    route = findRoute(ip);
                 }
 
-                if (!found) {
-                    Serial.print(F("[OcppServer] Unknown IP address! Please see addReceiveTXTcallback(IPAddress ...)\n"));
+                if (route) {
+                    if (DEBUG_OUT) Serial.print(F("[OcppServer] Client matches existing route!\n"));
+                    connectClient(num, *route);
+                } else {
+                    Serial.print(F("[OcppServer] Unknown charge point! Please see setReceiveTXTcallback(...)\n"));
                 }
             }
             break;
         case WStype_TEXT:
+            receiveMessage(num, payload, length, false);
+            break;
+        case WStype_BIN:
+            receiveMessage(num, payload, length, true);
+            break;
+        case WStype_FRAGMENT_TEXT_START:
+        case WStype_FRAGMENT_BIN_START:
+        case WStype_FRAGMENT:
+        case WStype_FRAGMENT_FIN:
             {
-                if (DEBUG_OUT || TRAFFIC_OUT) {
-                    Serial.print(F("[OcppServer] Get TXT from client: "));
-                    Serial.print(num);
-                    Serial.print(F(", TXT = "));
-                    Serial.println((const char*) payload);
-                }
-
-                bool found = false;
-                for (auto route = receiveTXTrouting.begin(); route != receiveTXTrouting.end(); ++route) {
-                    if (num == (*route).num) {
-                        if (DEBUG_OUT) Serial.print(F("\n"));
-                        if (!((*route).processTXT((const char*) payload, length))) {
-                            Serial.print(F("[OcppServer] Processing WebSocket input event failed!\n"));
-                        }
-                        found = true;
-                        break;
-                    }
+                auto client = clients.find(num);
+                if (client == clients.end()) {
+                    Serial.print(F("[OcppServer] Received fragment from unknown client!\n"));
+                    break;
                 }
-
-                if (!found) {
-                    Serial.print(F("[OcppServer] Received msg from unknown client!\n"));
+                FragmentBuffer& fragments = client->second->fragments;
+                if (type == WStype_FRAGMENT_TEXT_START || type == WStype_FRAGMENT_BIN_START) {
+                    fragments.begin(payload, length, type == WStype_FRAGMENT_BIN_START);
+                } else if (type == WStype_FRAGMENT) {
+                    fragments.add(payload, length);
+                } else if (fragments.finish(payload, length)) {
+                    receiveMessage(num, (const uint8_t*) fragments.data(), fragments.size(), fragments.isBinary());
                 }
             }
             break;
@@ -97,8 +124,6 @@ void OcppServer::wsockEvent(WsClient num, WStype_t type, uint8_t * payload, size
             // answer to a ping we send
             Serial.printf("[OcppServer] get pong, client = %u\n", num);
             break;
-        case WStype_FRAGMENT_TEXT_START: //fragments are not supported
-        case WStype_BIN:
         default:
             Serial.print(F("[OcppServer] Unsupported WebSocket event type, client = "));
             Serial.println(num);
@@ -106,6 +131,43 @@ void OcppServer::wsockEvent(WsClient num, WStype_t type, uint8_t * payload, size
     }
 }
 
+void OcppServer::receiveMessage(WsClient num, const uint8_t *payload, size_t length, bool binary) {
+    if (DEBUG_OUT || TRAFFIC_OUT) {
+        if (binary) {
+            Serial.print(F("[OcppServer] Get BIN from client: "));
+            Serial.print(num);
+            Serial.print(F(", length = "));
+            Serial.println(length);
+        } else {
+            Serial.print(F("[OcppServer] Get TXT from client: "));
+            Serial.print(num);
+            Serial.print(F(", TXT = "));
+            Serial.println((const char*) payload);
+        }
+    }
+
+    auto client = clients.find(num);
+    if (client == clients.end()) {
+        Serial.print(F("[OcppServer] Received msg from unknown client!\n"));
+        return;
+    }
+
+    bool success = false;
+    if (binary) {
+        if (!client->second->processBIN) {
+            Serial.print(F("[OcppServer] Binary msg not supported by the route!\n"));
+            return;
+        }
+        success = client->second->processBIN(payload, length);
+    } else {
+        success = client->second->processTXT((const char*) payload, length);
+    }
+
+    if (!success) {
+        Serial.print(F("[OcppServer] Processing WebSocket input event failed!\n"));
+    }
+}
+
 OcppServer *OcppServer::instance = NULL;
 
 OcppServer *OcppServer::getInstance() {
@@ -119,51 +181,140 @@ void OcppServer::loop() {
     wsockServer.loop();
 }
 
+void OcppServer::connectClient(WsClient num, ReceiveTXTroute& route) {
+    disconnectClient(num); //in case the client number is still assigned to another route
+
+    if (route.num >= 0 && route.num != num) {
+        //the charge point reconnected before the old connection has been closed
+        clients.erase((WsClient) route.num);
+        wsockServer.disconnect((WsClient) route.num);
+    }
+
+    route.num = num;
+    clients[num] = &route;
+
+    if (route.onConnectionState) {
+        route.onConnectionState(true);
+    }
+}
+
+void OcppServer::disconnectClient(WsClient num) {
+    auto client = clients.find(num);
+    if (client != clients.end()) {
+        ReceiveTXTroute *route = client->second;
+        route->num = -1;
+        clients.erase(client);
+        if (route->onConnectionState) {
+            route->onConnectionState(false);
+        }
+    }
+}
+
+void OcppServer::removeRoute(ReceiveTXTroute& route) {
+    if (route.num >= 0) {
+        clients.erase((WsClient) route.num);
+    }
+}
+
+ReceiveTXTroute *OcppServer::findRoute(const std::string& cpIdentity) {
+    auto route = routesByIdentity.find(cpIdentity);
+    return route != routesByIdentity.end() ? &route->second : nullptr;
+}
+
+ReceiveTXTroute *OcppServer::findRoute(IPAddress& ip_addr) {
+    auto route = routesByIp.find((uint32_t) ip_addr);
+    return route != routesByIp.end() ? &route->second : nullptr;
+}
+
+void OcppServer::setReceiveTXTcallback(const std::string& cpIdentity, ReceiveTXTcallback &callback) {
+    routesByIdentity[cpIdentity].processTXT = callback; //adds a new route or updates the callback of the existing one
+}
+
 void OcppServer::setReceiveTXTcallback(IPAddress &ip_addr, ReceiveTXTcallback &callback) {
-    /*
-     * Does route identified by ip_addr already exist?
-     */
-    std::vector<ReceiveTXTroute>::iterator result = std::find_if(receiveTXTrouting.begin(), receiveTXTrouting.end(),
-        [ip_addr](const ReceiveTXTroute &elem) {
-            return elem.ip_addr == ip_addr;
-        });
-    
-    if (result != receiveTXTrouting.end()) {
-        //found a route. Update callback
-        (*result).processTXT = callback;
-    } else {
-        //no route found. Add new one
-        ReceiveTXTroute route {};
-        route.ip_addr = ip_addr;
-        route.processTXT = callback;
-        receiveTXTrouting.push_back(route);
+    routesByIp[(uint32_t) ip_addr].processTXT = callback;
+}
+
+void OcppServer::setReceiveBINcallback(const std::string& cpIdentity, ReceiveBINcallback &callback) {
+    routesByIdentity[cpIdentity].processBIN = callback;
+}
+
+void OcppServer::setReceiveBINcallback(IPAddress &ip_addr, ReceiveBINcallback &callback) {
+    routesByIp[(uint32_t) ip_addr].processBIN = callback;
+}
+
+void OcppServer::setConnectionStateCallback(const std::string& cpIdentity, ConnectionStateCallback &callback) {
+    routesByIdentity[cpIdentity].onConnectionState = callback;
+}
+
+void OcppServer::setConnectionStateCallback(IPAddress &ip_addr, ConnectionStateCallback &callback) {
+    routesByIp[(uint32_t) ip_addr].onConnectionState = callback;
+}
+
+void OcppServer::removeReceiveTXTcallback(const std::string& cpIdentity) {
+    auto route = routesByIdentity.find(cpIdentity);
+    if (route != routesByIdentity.end()) {
+        removeRoute(route->second);
+        routesByIdentity.erase(route);
     }
 }
 
 void OcppServer::removeReceiveTXTcallback(IPAddress &ip_addr) {
-    receiveTXTrouting.erase(std::remove_if(receiveTXTrouting.begin(), receiveTXTrouting.end(), 
-        [ip_addr](const ReceiveTXTroute &elem) {
-            return elem.ip_addr == ip_addr;
-        }), receiveTXTrouting.end());
+    auto route = routesByIp.find((uint32_t) ip_addr);
+    if (route != routesByIp.end()) {
+        removeRoute(route->second);
+        routesByIp.erase(route);
+    }
 }
 
-bool OcppServer::sendTXT(IPAddress &ip_addr, std::string &out) {
+bool OcppServer::sendTXT(ReceiveTXTroute *route, const char *payload, size_t len) {
+    if (!route || route->num < 0) {
+        Serial.print(F("[OcppServer] Tried to send TXT for unregistered or offline charge point! Abort\n"));
+        return false;
+    }
 
-    WsClient mClient;
+    return wsockServer.sendTXT((WsClient) route->num, payload, len);
+}
 
-    std::vector<ReceiveTXTroute>::iterator result = std::find_if(receiveTXTrouting.begin(), receiveTXTrouting.end(),
-        [ip_addr](const ReceiveTXTroute &elem) {
-            return elem.ip_addr == ip_addr;
-        });
-        
-    if (result != receiveTXTrouting.end()) {
-        mClient = (*result).num;
-    } else {
-        Serial.print(F("[OcppServer] Tried to send TXT for unregistered IP address! Abort\n"));
+bool OcppServer::sendTXT(ReceiveTXTroute *route, uint8_t *frame, size_t len) {
+    if (!route || route->num < 0) {
+        Serial.print(F("[OcppServer] Tried to send TXT for unregistered or offline charge point! Abort\n"));
+        return false;
+    }
+
+    return wsockServer.sendTXT((WsClient) route->num, frame, len, true);
+}
+
+bool OcppServer::sendBIN(ReceiveTXTroute *route, uint8_t *frame, size_t len) {
+    if (!route || route->num < 0) {
+        Serial.print(F("[OcppServer] Tried to send BIN for unregistered or offline charge point! Abort\n"));
         return false;
     }
 
-    return wsockServer.sendTXT(mClient, out.c_str(), out.length());
+    return wsockServer.sendBIN((WsClient) route->num, frame, len, true);
+}
+
+bool OcppServer::sendTXT(const std::string& cpIdentity, std::string &out) {
+    return sendTXT(findRoute(cpIdentity), out.c_str(), out.length());
+}
+
+bool OcppServer::sendTXT(IPAddress &ip_addr, std::string &out) {
+    return sendTXT(findRoute(ip_addr), out.c_str(), out.length());
+}
+
+bool OcppServer::sendTXT(const std::string& cpIdentity, uint8_t *frame, size_t len) {
+    return sendTXT(findRoute(cpIdentity), frame, len);
+}
+
+bool OcppServer::sendTXT(IPAddress &ip_addr, uint8_t *frame, size_t len) {
+    return sendTXT(findRoute(ip_addr), frame, len);
+}
+
+bool OcppServer::sendBIN(const std::string& cpIdentity, uint8_t *frame, size_t len) {
+    return sendBIN(findRoute(cpIdentity), frame, len);
+}
+
+bool OcppServer::sendBIN(IPAddress &ip_addr, uint8_t *frame, size_t len) {
+    return sendBIN(findRoute(ip_addr), frame, len);
 }
 
 #endif //ndef AO_CUSTOM_WS
@@ -5,8 +5,10 @@
 #ifndef OCPPSERVER_H
 #define OCPPSERVER_H
 
-#include <vector>
+#include <string>
+#include <unordered_map>
 #include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Core/FragmentBuffer.h>
 
 namespace ArduinoOcpp {
 
@@ -22,18 +24,44 @@ namespace ArduinoOcpp {
 namespace EspWiFi {
 
 struct ReceiveTXTroute {
-    IPAddress ip_addr;
-    WsClient num;
     ReceiveTXTcallback processTXT;
+    ReceiveBINcallback processBIN; //optional, for MessagePack framing
+    ConnectionStateCallback onConnectionState; //optional
+    int num = -1; //WebSocket client number while the charge point is connected, -1 otherwise
+    FragmentBuffer fragments; //reassembles fragmented messages of this charge point
 };
 
+/*
+ * Routes the WebSocket traffic of the central system side to the OcppServerSockets. Charge points are identified
+ * by the last segment of the WebSocket URL path (e.g. ws://<server>/ocpp/<cpIdentity>), so that several chargers
+ * behind the same NAT can be told apart. Routes by IP address are still supported for chargers which connect
+ * without their identity in the path.
+ * 
+ * All lookups are hash map accesses, so routing costs the same regardless of the number of connected chargers.
+ * The number of simultaneous clients is limited by WEBSOCKETS_SERVER_CLIENT_MAX of the WebSockets library
+ */
 class OcppServer {
 private:
 
-    std::vector<ReceiveTXTroute> receiveTXTrouting;
+    std::unordered_map<std::string, ReceiveTXTroute> routesByIdentity;
+    std::unordered_map<uint32_t, ReceiveTXTroute> routesByIp;
+    std::unordered_map<WsClient, ReceiveTXTroute*> clients; //connected clients. Points into one of the route maps
 
     WebSocketsServer wsockServer = WebSocketsServer(80);
 
+    void connectClient(WsClient num, ReceiveTXTroute& route);
+    void disconnectClient(WsClient num);
+    void removeRoute(ReceiveTXTroute& route);
+
+    void receiveMessage(WsClient num, const uint8_t *payload, size_t length, bool binary);
+
+    ReceiveTXTroute *findRoute(const std::string& cpIdentity);
+    ReceiveTXTroute *findRoute(IPAddress& ip_addr);
+
+    bool sendTXT(ReceiveTXTroute *route, const char *payload, size_t len);
+    bool sendTXT(ReceiveTXTroute *route, uint8_t *frame, size_t len);
+    bool sendBIN(ReceiveTXTroute *route, uint8_t *frame, size_t len);
+
     OcppServer();
     static OcppServer *instance;
 public:
@@ -43,11 +71,33 @@ public:
 
     void wsockEvent(WsClient num, WStype_t type, uint8_t * payload, size_t length);
 
+    void setReceiveTXTcallback(const std::string& cpIdentity, ReceiveTXTcallback &callback);
     void setReceiveTXTcallback(IPAddress &ip_addr, ReceiveTXTcallback &callback);
 
+    void setReceiveBINcallback(const std::string& cpIdentity, ReceiveBINcallback &callback);
+    void setReceiveBINcallback(IPAddress &ip_addr, ReceiveBINcallback &callback);
+
+    void setConnectionStateCallback(const std::string& cpIdentity, ConnectionStateCallback &callback);
+    void setConnectionStateCallback(IPAddress &ip_addr, ConnectionStateCallback &callback);
+
+    void removeReceiveTXTcallback(const std::string& cpIdentity);
     void removeReceiveTXTcallback(IPAddress &ip_addr);
 
+    bool sendTXT(const std::string& cpIdentity, std::string &out);
     bool sendTXT(IPAddress &ip_addr, std::string &out);
+
+    /*
+     * Sends a frame which was written behind WEBSOCKETS_MAX_HEADER_SIZE reserved bytes. frame points to the reserved
+     * bytes and len is the length of the payload only
+     */
+    bool sendTXT(const std::string& cpIdentity, uint8_t *frame, size_t len);
+    bool sendTXT(IPAddress &ip_addr, uint8_t *frame, size_t len);
+
+    /*
+     * Binary counterparts of sendTXT() with the same reserved header bytes
+     */
+    bool sendBIN(const std::string& cpIdentity, uint8_t *frame, size_t len);
+    bool sendBIN(IPAddress &ip_addr, uint8_t *frame, size_t len);
 };
 
 } //end namespace EspWiFi
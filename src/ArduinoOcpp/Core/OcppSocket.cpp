@@ -6,10 +6,34 @@
 #include <ArduinoOcpp/Core/OcppServer.h>
 #include <ArduinoOcpp/Debug.h>
 
-#ifndef AO_CUSTOM_WS
+#include <string.h>
 
 using namespace ArduinoOcpp;
 
+char *OcppSocket::reserveTXT(size_t maxLen) {
+    frameBuf.resize(maxLen);
+    return &frameBuf[0];
+}
+
+bool OcppSocket::commitTXT(size_t len) {
+    if (len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    frameBuf.resize(len); //keeps the capacity for the next frame
+    return sendTXT(frameBuf);
+}
+
+bool OcppSocket::commitBIN(size_t len) {
+    if (len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    return sendBIN((const uint8_t*) frameBuf.data(), len);
+}
+
+#ifndef AO_CUSTOM_WS
+
 using namespace ArduinoOcpp::EspWiFi;
 
 OcppClientSocket::OcppClientSocket(WebSocketsClient *wsock) : wsock(wsock) {
@@ -24,24 +48,81 @@ bool OcppClientSocket::sendTXT(std::string &out) {
     return wsock->sendTXT(out.c_str(), out.length());
 }
 
+char *OcppClientSocket::reserveTXT(size_t maxLen) {
+    frameBuf.resize(WEBSOCKETS_MAX_HEADER_SIZE + maxLen);
+    return (char*) frameBuf.data() + WEBSOCKETS_MAX_HEADER_SIZE;
+}
+
+bool OcppClientSocket::commitTXT(size_t len) {
+    if (WEBSOCKETS_MAX_HEADER_SIZE + len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    //the WebSockets library writes the header into the reserved space and masks the payload in place
+    return wsock->sendTXT(frameBuf.data(), len, true);
+}
+
+bool OcppClientSocket::sendBIN(const uint8_t *payload, size_t len) {
+    return wsock->sendBIN(payload, len);
+}
+
+bool OcppClientSocket::commitBIN(size_t len) {
+    if (WEBSOCKETS_MAX_HEADER_SIZE + len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    return wsock->sendBIN(frameBuf.data(), len, true);
+}
+
 void OcppClientSocket::setReceiveTXTcallback(ReceiveTXTcallback &callback) {
-    wsock->onEvent([callback](WStype_t type, uint8_t * payload, size_t length) {
+    receiveTXT = callback;
+    registerEventHandler();
+}
+
+void OcppClientSocket::setReceiveBINcallback(ReceiveBINcallback &callback) {
+    receiveBIN = callback;
+    registerEventHandler();
+}
+
+void OcppClientSocket::setConnectionStateCallback(ConnectionStateCallback &callback) {
+    onConnectionState = callback;
+    registerEventHandler();
+}
+
+void OcppClientSocket::registerEventHandler() {
+    wsock->onEvent([this](WStype_t type, uint8_t * payload, size_t length) {
         switch (type) {
             case WStype_DISCONNECTED:
                 AO_DBG_INFO("Disconnected");
+                if (onConnectionState) {
+                    onConnectionState(false);
+                }
                 break;
             case WStype_CONNECTED:
                 AO_DBG_INFO("Connected to url: %s", payload);
+                if (onConnectionState) {
+                    onConnectionState(true);
+                }
                 break;
             case WStype_TEXT:
-                AO_DBG_TRAFFIC_IN(payload);
-
-                if (!callback((const char *) payload, length)) { //forward message to OcppEngine
-                    AO_DBG_WARN("Processing WebSocket input event failed");
-                }
+                receiveMessage(payload, length, false);
                 break;
             case WStype_BIN:
-                AO_DBG_WARN("Binary data stream not supported");
+                receiveMessage(payload, length, true);
+                break;
+            case WStype_FRAGMENT_TEXT_START:
+                fragments.begin(payload, length, false);
+                break;
+            case WStype_FRAGMENT_BIN_START:
+                fragments.begin(payload, length, true);
+                break;
+            case WStype_FRAGMENT:
+                fragments.add(payload, length);
+                break;
+            case WStype_FRAGMENT_FIN:
+                if (fragments.finish(payload, length)) {
+                    receiveMessage((const uint8_t*) fragments.data(), fragments.size(), fragments.isBinary());
+                }
                 break;
             case WStype_PING:
                 // pong will be send automatically
@@ -51,7 +132,6 @@ void OcppClientSocket::setReceiveTXTcallback(ReceiveTXTcallback &callback) {
                 // answer to a ping we send
                 AO_DBG_TRAFFIC_IN("WS pong");
                 break;
-            case WStype_FRAGMENT_TEXT_START: //fragments are not supported
             default:
                 AO_DBG_WARN("Unsupported WebSocket event type");
                 break;
@@ -59,12 +139,38 @@ void OcppClientSocket::setReceiveTXTcallback(ReceiveTXTcallback &callback) {
     });
 }
 
+void OcppClientSocket::receiveMessage(const uint8_t *payload, size_t length, bool binary) {
+    if (binary) {
+        AO_DBG_TRAFFIC_IN("WS binary frame");
+
+        if (!receiveBIN) {
+            AO_DBG_WARN("Binary data stream not supported");
+        } else if (!receiveBIN(payload, length)) {
+            AO_DBG_WARN("Processing WebSocket input event failed");
+        }
+    } else {
+        AO_DBG_TRAFFIC_IN(payload);
+
+        if (!receiveTXT || !receiveTXT((const char *) payload, length)) { //forward message to OcppEngine
+            AO_DBG_WARN("Processing WebSocket input event failed");
+        }
+    }
+}
+
 OcppServerSocket::OcppServerSocket(IPAddress &ip_addr) : ip_addr(ip_addr) {
     
 }
 
+OcppServerSocket::OcppServerSocket(const char *cpIdentity) : cpIdentity(cpIdentity) {
+
+}
+
 OcppServerSocket::~OcppServerSocket() {
-    OcppServer::getInstance()->removeReceiveTXTcallback(this->ip_addr);
+    if (!cpIdentity.empty()) {
+        OcppServer::getInstance()->removeReceiveTXTcallback(cpIdentity);
+    } else {
+        OcppServer::getInstance()->removeReceiveTXTcallback(this->ip_addr);
+    }
 }
 
 void OcppServerSocket::loop() {
@@ -73,11 +179,68 @@ void OcppServerSocket::loop() {
 
 bool OcppServerSocket::sendTXT(std::string &out) {
     AO_DBG_TRAFFIC_OUT(out.c_str());
+    if (!cpIdentity.empty()) {
+        return OcppServer::getInstance()->sendTXT(cpIdentity, out);
+    }
     return OcppServer::getInstance()->sendTXT(ip_addr, out);
 }
 
+char *OcppServerSocket::reserveTXT(size_t maxLen) {
+    frameBuf.resize(WEBSOCKETS_MAX_HEADER_SIZE + maxLen);
+    return (char*) frameBuf.data() + WEBSOCKETS_MAX_HEADER_SIZE;
+}
+
+bool OcppServerSocket::commitTXT(size_t len) {
+    if (WEBSOCKETS_MAX_HEADER_SIZE + len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    if (!cpIdentity.empty()) {
+        return OcppServer::getInstance()->sendTXT(cpIdentity, frameBuf.data(), len);
+    }
+    return OcppServer::getInstance()->sendTXT(ip_addr, frameBuf.data(), len);
+}
+
 void OcppServerSocket::setReceiveTXTcallback(ReceiveTXTcallback &callback) {
-    OcppServer::getInstance()->setReceiveTXTcallback(ip_addr, callback);
+    if (!cpIdentity.empty()) {
+        OcppServer::getInstance()->setReceiveTXTcallback(cpIdentity, callback);
+    } else {
+        OcppServer::getInstance()->setReceiveTXTcallback(ip_addr, callback);
+    }
+}
+
+bool OcppServerSocket::sendBIN(const uint8_t *payload, size_t len) {
+    //the server sends frames from the reserved buffer only. Copy the payload behind a reserved header
+    char *buf = reserveTXT(len);
+    memcpy(buf, payload, len);
+    return commitBIN(len);
+}
+
+bool OcppServerSocket::commitBIN(size_t len) {
+    if (WEBSOCKETS_MAX_HEADER_SIZE + len > frameBuf.size()) {
+        AO_DBG_ERR("Frame exceeds reserved buffer");
+        return false;
+    }
+    if (!cpIdentity.empty()) {
+        return OcppServer::getInstance()->sendBIN(cpIdentity, frameBuf.data(), len);
+    }
+    return OcppServer::getInstance()->sendBIN(ip_addr, frameBuf.data(), len);
+}
+
+void OcppServerSocket::setReceiveBINcallback(ReceiveBINcallback &callback) {
+    if (!cpIdentity.empty()) {
+        OcppServer::getInstance()->setReceiveBINcallback(cpIdentity, callback);
+    } else {
+        OcppServer::getInstance()->setReceiveBINcallback(ip_addr, callback);
+    }
+}
+
+void OcppServerSocket::setConnectionStateCallback(ConnectionStateCallback &callback) {
+    if (!cpIdentity.empty()) {
+        OcppServer::getInstance()->setConnectionStateCallback(cpIdentity, callback);
+    } else {
+        OcppServer::getInstance()->setConnectionStateCallback(ip_addr, callback);
+    }
 }
 
 #endif
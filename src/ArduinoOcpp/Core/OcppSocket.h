@@ -7,12 +7,17 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 
 namespace ArduinoOcpp {
 
 using ReceiveTXTcallback = std::function<bool(const char*, size_t)>;
+using ReceiveBINcallback = std::function<bool(const uint8_t*, size_t)>;
+using ConnectionStateCallback = std::function<void(bool connected)>;
 
 class OcppSocket {
+private:
+    std::string frameBuf; //backing buffer of the default reserveTXT() implementation
 public:
     OcppSocket() = default;
     virtual ~OcppSocket() = default;
@@ -21,7 +26,36 @@ public:
 
     virtual bool sendTXT(std::string &out) = 0;
 
+    /**
+     * Streaming send API. reserveTXT(maxLen) returns a buffer with space for at least maxLen characters.
+     * The caller writes the frame directly into it and then calls commitTXT(len) with the final length to
+     * send the first len characters as one text frame. Returns nullptr if no buffer is available.
+     * 
+     * The default implementation reuses one buffer per socket and hands it over to sendTXT(). Sockets
+     * which can write into the frame buffer of the WebSocket library should override both functions.
+     */
+    virtual char *reserveTXT(size_t maxLen);
+    virtual bool commitTXT(size_t len);
+
     virtual void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) = 0; //ReceiveTXTcallback is defined in OcppServer.h
+
+    /**
+     * Binary frames for the MessagePack framing of the OcppConnection (see AO_FRAMING_MODE). Sockets without binary
+     * support keep the default implementations: sending fails and incoming binary frames are never reported.
+     * 
+     * commitBIN(len) sends the first len bytes of the buffer from reserveTXT() as one binary frame
+     */
+    virtual bool sendBIN(const uint8_t *payload, size_t len) {return false;}
+    virtual bool commitBIN(size_t len);
+
+    virtual void setReceiveBINcallback(ReceiveBINcallback &receiveBIN) { }
+
+    /**
+     * Reports when the WebSocket connection is established or closed. Message IDs are only unique within one
+     * connection, so the OcppConnection resets its per-connection state then. Sockets which can't tell keep the
+     * default implementation and never report
+     */
+    virtual void setConnectionStateCallback(ConnectionStateCallback &onConnectionState) { }
 };
 
 } //end namespace ArduinoOcpp
@@ -31,6 +65,10 @@ public:
 #include <WebSocketsClient.h>
 #include <WebSocketsServer.h>
 
+#include <ArduinoOcpp/Core/FragmentBuffer.h>
+
+#include <vector>
+
 namespace ArduinoOcpp {
 namespace EspWiFi {
 
@@ -38,6 +76,13 @@ class OcppClientSocket : public OcppSocket {
 private:
     //std::shared_ptr<WebSocketsClient> wsock;
     WebSocketsClient *wsock;
+    std::vector<uint8_t> frameBuf; //WEBSOCKETS_MAX_HEADER_SIZE bytes for the WS header, then the payload
+    ReceiveTXTcallback receiveTXT;
+    ReceiveBINcallback receiveBIN;
+    ConnectionStateCallback onConnectionState;
+    FragmentBuffer fragments;
+    void registerEventHandler();
+    void receiveMessage(const uint8_t *payload, size_t length, bool binary);
 public:
     //OcppClientSocket(ReceiveTXTcallback &receiveTXT, std::shared_ptr<WebSocketsClient> wsock);
     OcppClientSocket(WebSocketsClient *wsock);
@@ -46,21 +91,48 @@ public:
 
     bool sendTXT(std::string &out);
 
+    char *reserveTXT(size_t maxLen);
+    bool commitTXT(size_t len);
+
     void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT);
+
+    bool sendBIN(const uint8_t *payload, size_t len);
+    bool commitBIN(size_t len);
+
+    void setReceiveBINcallback(ReceiveBINcallback &receiveBIN);
+
+    void setConnectionStateCallback(ConnectionStateCallback &onConnectionState);
 };
 
 class OcppServerSocket : public OcppSocket {
 private:
     IPAddress ip_addr;
+    std::string cpIdentity; //if set, the OcppServer routes by charge point identity instead of IP address
+    std::vector<uint8_t> frameBuf;
 public:
     OcppServerSocket(IPAddress &ip_addr);
+
+    /*
+     * Socket of the charge point which connects with cpIdentity as last segment of the URL path
+     */
+    OcppServerSocket(const char *cpIdentity);
     ~OcppServerSocket();
 
     void loop();
 
     bool sendTXT(std::string &out);
 
+    char *reserveTXT(size_t maxLen);
+    bool commitTXT(size_t len);
+
     void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT);
+
+    bool sendBIN(const uint8_t *payload, size_t len);
+    bool commitBIN(size_t len);
+
+    void setReceiveBINcallback(ReceiveBINcallback &receiveBIN);
+
+    void setConnectionStateCallback(ConnectionStateCallback &onConnectionState);
 };
 
 } //end namespace EspWiFi
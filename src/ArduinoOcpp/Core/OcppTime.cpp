@@ -5,6 +5,9 @@
 #include <ArduinoOcpp/Core/OcppTime.h>
 #include <ArduinoOcpp/Platform.h>
 
+#include <ctype.h>
+#include <string.h>
+
 namespace ArduinoOcpp {
 
 const OcppTimestamp MIN_TIME = OcppTimestamp(2010, 0, 0, 0, 0, 0);
@@ -306,6 +309,17 @@ otime_t OcppTime::getOcppTimeScalar() {
     return system_clock();
 }
 
+unsigned long OcppTime::getMsUntil(const OcppTimestamp &t) {
+    otime_t secs = t - getOcppTimestampNow();
+    if (secs <= 0) {
+        return 0;
+    }
+    if ((unsigned long) secs >= AO_WAKEUP_NEVER / 1000UL) {
+        return AO_WAKEUP_NEVER;
+    }
+    return (unsigned long) secs * 1000UL;
+}
+
 const OcppTimestamp &OcppTime::getOcppTimestampNow() {
     otime_t tNow = system_clock();
     if (previousUpdate != tNow) {
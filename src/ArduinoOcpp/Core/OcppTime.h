@@ -6,6 +6,8 @@
 #define OCPPTIME_H
 
 #include <functional>
+#include <stddef.h>
+#include <stdint.h>
 
 namespace ArduinoOcpp {
 
@@ -101,6 +103,7 @@ public:
 
     otime_t getOcppTimeScalar(); //returns current time of the OCPP server in non-UNIX but signed integer format. t2 - t1 is the time difference in seconds. 
     const OcppTimestamp &getOcppTimestampNow();
+    unsigned long getMsUntil(const OcppTimestamp &t); //milliseconds from now until t; 0 if t is in the past; AO_WAKEUP_NEVER if too far in the future
     OcppTimestamp createTimestamp(otime_t scalar); //creates a timestamp in a JSON-serializable format. createTimestamp(getOcppTimeScalar()) will return the current OCPP time
     otime_t toOcppTimeScalar(const OcppTimestamp &otimestamp);
 
@@ -0,0 +1,178 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifdef AO_OPERATION_METRICS
+
+#include <ArduinoOcpp/Core/OperationMetrics.h>
+#include <ArduinoOcpp/Platform.h>
+#include <ArduinoOcpp/Debug.h>
+
+#include <ArduinoJson.h>
+#include <vector>
+
+using namespace ArduinoOcpp;
+using namespace ArduinoOcpp::OperationMetrics;
+
+namespace ArduinoOcpp {
+namespace OperationMetrics {
+
+static std::vector<ActionMetrics> entries;
+
+static ActionMetrics *findEntry(OcppAction action) {
+    for (auto& entry : entries) {
+        if (entry.actionId == action) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+static ActionMetrics *getOrCreateEntry(OcppAction action) {
+    auto entry = findEntry(action);
+    if (!entry) {
+        ActionMetrics newEntry;
+        newEntry.actionId = action;
+        newEntry.action = getOcppActionName(action);
+        entries.push_back(newEntry);
+        entry = &entries.back();
+    }
+    return entry;
+}
+
+static size_t countUsedBuckets(const Histogram& histogram) {
+    size_t used = AO_LATENCY_BUCKETS;
+    while (used > 0 && histogram.buckets[used - 1] == 0) {
+        used--;
+    }
+    return used;
+}
+
+} //end namespace OperationMetrics
+} //end namespace ArduinoOcpp
+
+void Histogram::add(unsigned long ms) {
+    size_t bucket = 0;
+    for (unsigned long rest = ms; rest >= 2 && bucket + 1 < AO_LATENCY_BUCKETS; rest >>= 1) {
+        bucket++;
+    }
+    buckets[bucket]++;
+    count++;
+    sumMs += ms;
+    if (ms > maxMs) {
+        maxMs = ms;
+    }
+}
+
+const char *OperationMetrics::getEventName(Event event) {
+    switch (event) {
+        case Event::Conf:
+            return "conf";
+        case Event::Error:
+            return "error";
+        case Event::Timeout:
+            return "timeout";
+        case Event::QueueWait:
+            return "wait";
+        default:
+            return "unknown";
+    }
+}
+
+void OperationMetrics::record(OcppAction action, Event event, unsigned long ms) {
+    if (event >= Event::EventCount) {
+        return;
+    }
+    getOrCreateEntry(action)->events[(size_t) event].add(ms);
+}
+
+void OperationMetrics::recordRetry(OcppAction action) {
+    getOrCreateEntry(action)->retries++;
+}
+
+const ActionMetrics *OperationMetrics::getMetrics(OcppAction action) {
+    return findEntry(action);
+}
+
+const ActionMetrics *OperationMetrics::getMetrics(const char *action) {
+    OcppAction id = getOcppAction(action);
+    if (id == OcppAction::Unknown) {
+        return nullptr;
+    }
+    return findEntry(id);
+}
+
+void OperationMetrics::forEach(std::function<void(const ActionMetrics& metrics)> fn) {
+    if (!fn) {
+        return;
+    }
+    for (auto& entry : entries) {
+        fn(entry);
+    }
+}
+
+void OperationMetrics::serialize(std::string& out) {
+    size_t capacity = JSON_ARRAY_SIZE(entries.size());
+    for (auto& entry : entries) {
+        capacity += JSON_OBJECT_SIZE(2 + (size_t) Event::EventCount); //action, retries, events
+        for (size_t i = 0; i < (size_t) Event::EventCount; i++) {
+            if (entry.events[i].count > 0) {
+                capacity += JSON_OBJECT_SIZE(4) + JSON_ARRAY_SIZE(countUsedBuckets(entry.events[i]));
+            }
+        }
+    }
+
+    DynamicJsonDocument doc {capacity};
+    JsonArray metrics = doc.to<JsonArray>();
+    for (auto& entry : entries) {
+        JsonObject actionMetrics = metrics.createNestedObject();
+        actionMetrics["action"] = entry.action; //static string, not copied
+        actionMetrics["retries"] = entry.retries;
+        for (size_t i = 0; i < (size_t) Event::EventCount; i++) {
+            const Histogram& histogram = entry.events[i];
+            if (histogram.count == 0) {
+                continue;
+            }
+            JsonObject event = actionMetrics.createNestedObject(getEventName((Event) i));
+            event["n"] = histogram.count;
+            event["avg"] = histogram.sumMs / histogram.count;
+            event["max"] = histogram.maxMs;
+            JsonArray buckets = event.createNestedArray("hist");
+            size_t used = countUsedBuckets(histogram);
+            for (size_t b = 0; b < used; b++) {
+                buckets.add(histogram.buckets[b]);
+            }
+        }
+    }
+
+    out.clear();
+    serializeJson(doc, out);
+}
+
+void OperationMetrics::dump() {
+    AO_CONSOLE_PRINTF("[AO] Operation metrics (latencies in ms)\n");
+    forEach([] (const ActionMetrics& entry) {
+        AO_CONSOLE_PRINTF("[AO] %s: retries=%lu\n", entry.action, entry.retries);
+        for (size_t i = 0; i < (size_t) Event::EventCount; i++) {
+            const Histogram& histogram = entry.events[i];
+            if (histogram.count == 0) {
+                continue;
+            }
+            AO_CONSOLE_PRINTF("[AO]     %-8s n=%lu avg=%lu max=%lu hist=",
+                    getEventName((Event) i),
+                    histogram.count,
+                    histogram.sumMs / histogram.count,
+                    histogram.maxMs);
+            size_t used = countUsedBuckets(histogram);
+            for (size_t b = 0; b < used; b++) {
+                AO_CONSOLE_PRINTF("%u%s", (unsigned int) histogram.buckets[b], b + 1 < used ? "," : "\n");
+            }
+        }
+    });
+}
+
+void OperationMetrics::reset() {
+    entries.clear();
+}
+
+#endif //def AO_OPERATION_METRICS
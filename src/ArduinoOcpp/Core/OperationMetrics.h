@@ -0,0 +1,98 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+/**
+ * Round-trip metrics of the operations which this device initiates. With the build flag AO_OPERATION_METRICS,
+ * the engine records per action (e.g. "StartTransaction"):
+ * 
+ *     - latency from sending the request to receiving the CALLRESULT
+ *     - latency from sending the request to receiving a CALLERROR
+ *     - time from initiating the operation until it times out
+ *     - queue wait, i.e. time from initiating the operation until it is sent for the first time
+ *     - number of retries
+ * 
+ * Latencies are collected in log2 histograms: bucket 0 counts latencies below 2 ms, bucket n counts latencies
+ * in [2^n, 2^(n+1)) ms, and the last bucket counts everything above.
+ * 
+ * Without AO_OPERATION_METRICS, the recording macros expand to nothing and this module isn't compiled in.
+ */
+
+#ifndef AO_OPERATIONMETRICS_H
+#define AO_OPERATIONMETRICS_H
+
+#ifdef AO_OPERATION_METRICS
+
+#include <ArduinoOcpp/Core/OcppAction.h>
+
+#include <functional>
+#include <string>
+#include <stdint.h>
+
+#ifndef AO_LATENCY_BUCKETS
+#define AO_LATENCY_BUCKETS 16 //the last bucket starts at 2^15 ms = 32.8 s
+#endif
+
+namespace ArduinoOcpp {
+namespace OperationMetrics {
+
+enum class Event : uint8_t {
+    Conf,       //send -> CALLRESULT
+    Error,      //send -> CALLERROR
+    Timeout,    //initiated -> timed out
+    QueueWait,  //initiated -> first send
+    EventCount
+};
+
+const char *getEventName(Event event);
+
+struct Histogram {
+    uint32_t buckets [AO_LATENCY_BUCKETS] = {0};
+    unsigned long count = 0;
+    unsigned long sumMs = 0;
+    unsigned long maxMs = 0;
+
+    void add(unsigned long ms);
+};
+
+struct ActionMetrics {
+    OcppAction actionId = OcppAction::Unknown;
+    const char *action = nullptr; //name of actionId
+    Histogram events [(size_t) Event::EventCount];
+    unsigned long retries = 0;
+
+    const Histogram& get(Event event) const {return events[(size_t) event];}
+};
+
+void record(OcppAction action, Event event, unsigned long ms);
+void recordRetry(OcppAction action);
+
+const ActionMetrics *getMetrics(OcppAction action); //nullptr if nothing has been recorded for this action
+const ActionMetrics *getMetrics(const char *action);
+
+void forEach(std::function<void(const ActionMetrics& metrics)> fn);
+
+/*
+ * Writes all metrics as compact JSON, e.g. for the data field of a DataTransfer:
+ * [{"action":"Heartbeat","retries":0,"conf":{"n":3,"avg":84,"max":120,"hist":[0,0,0,0,0,0,1,2]}}, ...]
+ * Trailing empty histogram buckets and events without samples are omitted.
+ */
+void serialize(std::string& out);
+
+void dump(); //print all metrics on the console
+
+void reset();
+
+} //end namespace OperationMetrics
+} //end namespace ArduinoOcpp
+
+#define AO_METRICS_RECORD(action, event, ms) ArduinoOcpp::OperationMetrics::record(action, ArduinoOcpp::OperationMetrics::Event::event, ms)
+#define AO_METRICS_RETRY(action) ArduinoOcpp::OperationMetrics::recordRetry(action)
+
+#else
+
+#define AO_METRICS_RECORD(action, event, ms)
+#define AO_METRICS_RETRY(action)
+
+#endif //def AO_OPERATION_METRICS
+#endif
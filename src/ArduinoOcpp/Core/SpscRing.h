@@ -0,0 +1,59 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <stddef.h>
+
+namespace ArduinoOcpp {
+
+/*
+ * Lock-free ring buffer for exactly one producer thread and one consumer thread. The slots are preallocated and
+ * accessed in place: the producer fills the slot from acquireWrite() and publishes it with commitWrite(), the
+ * consumer reads the slot from acquireRead() and releases it with commitRead(). Slot objects are never destroyed,
+ * so buffers inside them (e.g. the capacity of a std::string) are reused
+ */
+template <class T, size_t N>
+class SpscRing {
+private:
+    T slots [N];
+    std::atomic<size_t> head {0}; //next slot to read. Only written by the consumer
+    std::atomic<size_t> tail {0}; //next slot to write. Only written by the producer
+public:
+    //producer side. Returns nullptr if the ring is full
+    T *acquireWrite() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= N) {
+            return nullptr;
+        }
+        return &slots[t % N];
+    }
+
+    void commitWrite() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    //consumer side. Returns nullptr if the ring is empty
+    T *acquireRead() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[h % N];
+    }
+
+    void commitRead() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+};
+
+} //end namespace ArduinoOcpp
+
+#endif
@@ -0,0 +1,209 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include <ArduinoOcpp/Core/ThreadedOcppSocket.h>
+
+#ifdef AO_THREADED_SOCKET_SUPPORTED
+
+#include <ArduinoOcpp/Debug.h>
+
+#if defined(AO_PLATFORM_POSIX)
+#include <chrono>
+#else
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+using namespace ArduinoOcpp;
+
+ThreadedOcppSocket::ThreadedOcppSocket(OcppSocket& socket) : socket(socket) {
+
+    ReceiveTXTcallback onTXT = [this] (const char *payload, size_t length) {
+        pushIncoming(payload, length, FrameType::Text);
+        return true;
+    };
+    socket.setReceiveTXTcallback(onTXT);
+
+    ReceiveBINcallback onBIN = [this] (const uint8_t *payload, size_t length) {
+        pushIncoming((const char*) payload, length, FrameType::Binary);
+        return true;
+    };
+    socket.setReceiveBINcallback(onBIN);
+
+    ConnectionStateCallback onState = [this] (bool connected) {
+        pushIncoming("", 0, connected ? FrameType::Connected : FrameType::Disconnected);
+    };
+    socket.setConnectionStateCallback(onState);
+
+#if defined(AO_PLATFORM_POSIX)
+    ioThread = std::thread([this] () {
+        ioLoop();
+    });
+#else
+    if (xTaskCreatePinnedToCore(ioTask, "ao_io", AO_IO_TASK_STACK, this, AO_IO_TASK_PRIORITY, nullptr, AO_IO_TASK_CORE) != pdPASS) {
+        AO_DBG_ERR("Cannot create I/O task");
+        running = false;
+        stopped = true;
+    }
+#endif
+}
+
+ThreadedOcppSocket::~ThreadedOcppSocket() {
+    running = false;
+#if defined(AO_PLATFORM_POSIX)
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+#else
+    while (!stopped) {
+        vTaskDelay(1);
+    }
+#endif
+}
+
+#if !defined(AO_PLATFORM_POSIX)
+void ThreadedOcppSocket::ioTask(void *param) {
+    auto self = static_cast<ThreadedOcppSocket*>(param);
+    self->ioLoop();
+    self->stopped = true;
+    vTaskDelete(nullptr);
+}
+#endif
+
+void ThreadedOcppSocket::ioLoop() {
+    while (running) {
+        pump();
+#if defined(AO_PLATFORM_POSIX)
+        std::this_thread::sleep_for(std::chrono::milliseconds(AO_IO_POLL_MS));
+#else
+        vTaskDelay(AO_IO_POLL_MS / portTICK_PERIOD_MS > 0 ? AO_IO_POLL_MS / portTICK_PERIOD_MS : 1);
+#endif
+    }
+}
+
+void ThreadedOcppSocket::pump() {
+    while (!backlog.empty()) {
+        Frame *slot = incoming.acquireWrite();
+        if (!slot) {
+            break;
+        }
+        slot->data.swap(backlog.front().data);
+        slot->type = backlog.front().type;
+        incoming.commitWrite();
+        backlog.pop_front();
+    }
+
+    /*
+     * Backpressure: the inner socket is only read while the engine keeps up. Otherwise the frames wait in the
+     * network stack. Incoming frames are pushed by the receive callbacks; if one socket loop reports more frames
+     * than there are free slots, the rest waits in the backlog
+     */
+    if (backlog.empty() && incoming.acquireWrite()) {
+        socket.loop();
+    }
+
+    while (Frame *frame = outgoing.acquireRead()) {
+        bool success = frame->type == FrameType::Binary ?
+                socket.sendBIN((const uint8_t*) frame->data.data(), frame->data.length()) :
+                socket.sendTXT(frame->data);
+        if (!success) {
+            /*
+             * Keep the frame at the head and try again in the next round. Until then, sendTXT() fails on the
+             * engine thread as on an unthreaded socket which is offline, so the engine doesn't take the frames
+             * for sent and postpones its timeouts
+             */
+            if (!sendRefused) {
+                AO_DBG_WARN("Cannot send frame. Retry");
+            }
+            sendRefused = true;
+            break;
+        }
+        sendRefused = false;
+        outgoing.commitRead();
+    }
+}
+
+bool ThreadedOcppSocket::pushFrame(SpscRing<Frame, AO_IO_QUEUE_SIZE>& ring, const char *data, size_t len, FrameType type) {
+    Frame *slot = ring.acquireWrite();
+    if (!slot) {
+        return false;
+    }
+    slot->data.assign(data, len); //reuses the capacity of earlier frames in this slot
+    slot->type = type;
+    ring.commitWrite();
+    return true;
+}
+
+void ThreadedOcppSocket::pushIncoming(const char *data, size_t len, FrameType type) {
+    if (backlog.empty() && pushFrame(incoming, data, len, type)) {
+        return;
+    }
+    AO_DBG_DEBUG("I/O queue full. Keep frame until the engine has caught up");
+    backlog.emplace_back();
+    backlog.back().data.assign(data, len);
+    backlog.back().type = type;
+}
+
+void ThreadedOcppSocket::loop() {
+    while (Frame *frame = incoming.acquireRead()) {
+        bool success = false;
+        switch (frame->type) {
+            case FrameType::Text:
+                AO_DBG_TRAFFIC_IN(frame->data.c_str());
+                success = receiveTXT && receiveTXT(frame->data.c_str(), frame->data.length());
+                break;
+            case FrameType::Binary:
+                AO_DBG_TRAFFIC_IN("WS binary frame");
+                success = receiveBIN && receiveBIN((const uint8_t*) frame->data.data(), frame->data.length());
+                break;
+            case FrameType::Connected:
+            case FrameType::Disconnected:
+                if (onConnectionState) {
+                    onConnectionState(frame->type == FrameType::Connected);
+                }
+                success = true;
+                break;
+        }
+        if (!success) {
+            AO_DBG_WARN("Processing WebSocket input event failed");
+        }
+        incoming.commitRead();
+    }
+}
+
+bool ThreadedOcppSocket::sendTXT(std::string &out) {
+    if (sendRefused) {
+        return false;
+    }
+    if (!pushFrame(outgoing, out.c_str(), out.length(), FrameType::Text)) {
+        AO_DBG_WARN("I/O queue full");
+        return false;
+    }
+    return true;
+}
+
+bool ThreadedOcppSocket::sendBIN(const uint8_t *payload, size_t len) {
+    if (sendRefused) {
+        return false;
+    }
+    if (!pushFrame(outgoing, (const char*) payload, len, FrameType::Binary)) {
+        AO_DBG_WARN("I/O queue full");
+        return false;
+    }
+    return true;
+}
+
+void ThreadedOcppSocket::setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) {
+    this->receiveTXT = receiveTXT;
+}
+
+void ThreadedOcppSocket::setReceiveBINcallback(ReceiveBINcallback &receiveBIN) {
+    this->receiveBIN = receiveBIN;
+}
+
+void ThreadedOcppSocket::setConnectionStateCallback(ConnectionStateCallback &onConnectionState) {
+    this->onConnectionState = onConnectionState;
+}
+
+#endif //def AO_THREADED_SOCKET_SUPPORTED
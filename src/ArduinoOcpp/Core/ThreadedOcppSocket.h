@@ -0,0 +1,119 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef THREADEDOCPPSOCKET_H
+#define THREADEDOCPPSOCKET_H
+
+#include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Platform.h>
+
+#if defined(ESP32) || defined(AO_PLATFORM_POSIX)
+#define AO_THREADED_SOCKET_SUPPORTED
+#endif
+
+#ifdef AO_THREADED_SOCKET_SUPPORTED
+
+#include <ArduinoOcpp/Core/SpscRing.h>
+
+#include <atomic>
+#include <deque>
+#include <string>
+
+#if defined(AO_PLATFORM_POSIX)
+#include <thread>
+#endif
+
+#ifndef AO_IO_QUEUE_SIZE
+#define AO_IO_QUEUE_SIZE 8 //frames per direction between the I/O thread and the engine
+#endif
+
+#ifndef AO_IO_POLL_MS
+#define AO_IO_POLL_MS 1 //sleep of the I/O thread between two socket loops
+#endif
+
+#ifndef AO_IO_TASK_STACK
+#define AO_IO_TASK_STACK 8192 //ESP32 only: stack size of the I/O task. TLS handshakes need a large stack
+#endif
+
+#ifndef AO_IO_TASK_PRIORITY
+#define AO_IO_TASK_PRIORITY 1 //ESP32 only
+#endif
+
+#ifndef AO_IO_TASK_CORE
+#define AO_IO_TASK_CORE 0 //ESP32 only: the Arduino loop() runs on core 1
+#endif
+
+namespace ArduinoOcpp {
+
+/*
+ * Runs another OcppSocket on a dedicated I/O thread (a FreeRTOS task on the ESP32, a std::thread on POSIX), so
+ * that a blocking TLS handshake or a slow TCP write doesn't stall the thread which runs the engine and the
+ * charge control.
+ * 
+ * The engine uses this socket as usual. Frames are exchanged with the I/O thread through two lock-free
+ * single-producer / single-consumer rings of AO_IO_QUEUE_SIZE frames. sendTXT() only enqueues the frame and
+ * fails if the ring is full or if the inner socket refuses frames (e.g. offline); the engine then retries as if
+ * the connection was down. A frame which the inner socket refuses stays at the head of the ring and is sent
+ * again, so enqueued frames are never lost. Incoming frames and changes of the connection state are delivered to
+ * the engine during loop(), in the order in which they occurred. While the incoming ring is full, the I/O thread
+ * stops reading the inner socket, so that frames wait in the network stack instead of being dropped.
+ * 
+ * After the construction, the inner socket must only be accessed by the I/O thread. The thread stops when
+ * this object is destroyed
+ */
+class ThreadedOcppSocket : public OcppSocket {
+private:
+    OcppSocket& socket;
+
+    enum class FrameType {
+        Text,
+        Binary,
+        Connected, //no data. Connection state change of the inner socket
+        Disconnected
+    };
+
+    struct Frame {
+        std::string data;
+        FrameType type = FrameType::Text;
+    };
+    SpscRing<Frame, AO_IO_QUEUE_SIZE> outgoing; //producer: engine, consumer: I/O thread
+    SpscRing<Frame, AO_IO_QUEUE_SIZE> incoming; //producer: I/O thread, consumer: engine
+    std::deque<Frame> backlog; //I/O thread only: incoming frames which didn't fit into the ring during the last socket loop
+
+    ReceiveTXTcallback receiveTXT;
+    ReceiveBINcallback receiveBIN;
+    ConnectionStateCallback onConnectionState;
+
+    std::atomic<bool> sendRefused {false}; //true while the inner socket refuses the frame at the head of outgoing
+    std::atomic<bool> running {true};
+#if defined(AO_PLATFORM_POSIX)
+    std::thread ioThread;
+#else
+    std::atomic<bool> stopped {false};
+    static void ioTask(void *param);
+#endif
+
+    void ioLoop();
+    void pump(); //one round of the I/O thread
+    bool pushFrame(SpscRing<Frame, AO_IO_QUEUE_SIZE>& ring, const char *data, size_t len, FrameType type);
+    void pushIncoming(const char *data, size_t len, FrameType type); //never drops the frame
+public:
+    ThreadedOcppSocket(OcppSocket& socket);
+    ~ThreadedOcppSocket();
+
+    void loop(); //delivers the incoming frames
+
+    bool sendTXT(std::string &out);
+    bool sendBIN(const uint8_t *payload, size_t len);
+
+    void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT);
+    void setReceiveBINcallback(ReceiveBINcallback &receiveBIN);
+
+    void setConnectionStateCallback(ConnectionStateCallback &onConnectionState);
+};
+
+} //end namespace ArduinoOcpp
+
+#endif //def AO_THREADED_SOCKET_SUPPORTED
+#endif
@@ -8,6 +8,8 @@
 
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::Authorize;
 
 //Authorize::Authorize() {
@@ -81,10 +81,10 @@ void BootNotification::processConf(JsonObject payload){
 
     //only write if in valid range
     if (interval >= 1) {
-        std::shared_ptr<Configuration<int>> intervalConf = declareConfiguration<int>("HeartbeatInterval", 86400);
+        std::shared_ptr<Configuration<int>> intervalConf = getConfigurationStore().declareConfiguration<int>("HeartbeatInterval", 86400);
         if (intervalConf && interval != *intervalConf) {
             *intervalConf = interval;
-            configuration_save();
+            getConfigurationStore().save();
         }
     }
 
@@ -37,6 +37,10 @@ public:
 
     const char* getOcppOperationType();
 
+    size_t getMemoryUsage() {return sizeof(BootNotification) + (overridePayload ? overridePayload->capacity() : 0);}
+
+    bool isDroppable() {return false;} //the device is not operational before the first BootNotification.conf
+
     std::unique_ptr<DynamicJsonDocument> createReq();
 
     void processConf(JsonObject payload);
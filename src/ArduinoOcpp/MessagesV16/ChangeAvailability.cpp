@@ -7,6 +7,7 @@
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 
 #include <functional>
+#include <string.h>
 
 using ArduinoOcpp::Ocpp16::ChangeAvailability;
 
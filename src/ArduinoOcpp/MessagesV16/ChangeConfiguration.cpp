@@ -6,6 +6,8 @@
 #include <ArduinoOcpp/Core/Configuration.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::ChangeConfiguration;
 
 ChangeConfiguration::ChangeConfiguration() {
@@ -37,11 +39,11 @@ void ChangeConfiguration::processReq(JsonObject payload) {
     if (value.is<const char *>()) {
         const char *value_string = value.as<const char *>();
         if (value_string == nullptr || value_string[0] == '\0') {
-            auto configuration = getConfiguration(key);
+            auto configuration = getConfigurationStore().getConfiguration(key);
             if (configuration) {
                 if (configuration->permissionRemotePeerCanWrite()) {
                     configuration->setToBeRemoved();
-                    configuration_save();
+                    getConfigurationStore().save();
                     rebootRequired = true;
                 } else {
                     readOnly = true;
@@ -136,7 +138,7 @@ void ChangeConfiguration::processReq(JsonObject payload) {
         }
     }
 
-    std::shared_ptr<AbstractConfiguration> configuration = getConfiguration(key);
+    std::shared_ptr<AbstractConfiguration> configuration = getConfigurationStore().getConfiguration(key);
 
     if (configuration) {
         if (!configuration->permissionRemotePeerCanWrite()) {
@@ -165,11 +167,11 @@ void ChangeConfiguration::processReq(JsonObject payload) {
     } else {
         //configuration does not exist yet. Create new entry
         if (isInt) {
-            configuration = std::static_pointer_cast<AbstractConfiguration>(declareConfiguration<int>(key, numInt));
+            configuration = std::static_pointer_cast<AbstractConfiguration>(getConfigurationStore().declareConfiguration<int>(key, numInt));
         } else if (isFloat) {
-            configuration = std::static_pointer_cast<AbstractConfiguration>(declareConfiguration<float>(key, numFloat));
+            configuration = std::static_pointer_cast<AbstractConfiguration>(getConfigurationStore().declareConfiguration<float>(key, numFloat));
         } else if (isString) {
-            configuration = std::static_pointer_cast<AbstractConfiguration>(declareConfiguration<const char*>(key, value_string));
+            configuration = std::static_pointer_cast<AbstractConfiguration>(getConfigurationStore().declareConfiguration<const char*>(key, value_string));
         } else {
             err = true;
             AO_DBG_WARN("Could not parse value");
@@ -184,7 +186,7 @@ void ChangeConfiguration::processReq(JsonObject payload) {
     }
 
     //success
-    configuration_save(); //TODO encapsulate in AbstractConfiguration: will split configurations in multiple files. Only write back modified data
+    getConfigurationStore().save(); //TODO encapsulate in AbstractConfiguration: will split configurations in multiple files. Only write back modified data
 
     if (configuration->requiresRebootWhenChanged()) {
         rebootRequired = true;
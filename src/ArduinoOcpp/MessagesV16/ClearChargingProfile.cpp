@@ -8,6 +8,7 @@
 #include <ArduinoOcpp/Debug.h>
 
 #include <functional>
+#include <string.h>
 
 using ArduinoOcpp::Ocpp16::ClearChargingProfile;
 
@@ -7,8 +7,9 @@
 
 using ArduinoOcpp::Ocpp16::DataTransfer;
 
-DataTransfer::DataTransfer(const std::string &msg) {
+DataTransfer::DataTransfer(const std::string &msg, const std::string &messageId) {
     this->msg = msg;
+    this->messageId = messageId;
 }
 
 const char* DataTransfer::getOcppOperationType(){
@@ -16,9 +17,12 @@ const char* DataTransfer::getOcppOperationType(){
 }
 
 std::unique_ptr<DynamicJsonDocument> DataTransfer::createReq() {
-    auto doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(2) + (msg.length() + 1)));
+    auto doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(3) + (msg.length() + 1) + (messageId.length() + 1)));
     JsonObject payload = doc->to<JsonObject>();
     payload["vendorId"] = "CustomVendor";
+    if (!messageId.empty()) {
+        payload["messageId"] = messageId;
+    }
     payload["data"] = msg;
     return doc;
 }
@@ -13,8 +13,9 @@ namespace Ocpp16 {
 class DataTransfer : public OcppMessage {
 private:
     std::string msg {};
+    std::string messageId {};
 public:
-    DataTransfer(const std::string &msg);
+    DataTransfer(const std::string &msg, const std::string &messageId = std::string());
 
     const char* getOcppOperationType();
 
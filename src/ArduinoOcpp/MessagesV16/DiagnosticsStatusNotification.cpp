@@ -3,19 +3,13 @@
 // MIT License
 
 #include <ArduinoOcpp/MessagesV16/DiagnosticsStatusNotification.h>
-#include <ArduinoOcpp/Core/OcppEngine.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/Diagnostics/DiagnosticsService.h>
 
 using ArduinoOcpp::Ocpp16::DiagnosticsStatusNotification;
 
-DiagnosticsStatusNotification::DiagnosticsStatusNotification() {
-    if (defaultOcppEngine && defaultOcppEngine->getOcppModel().getDiagnosticsService()) {
-        auto diagnosticsService = defaultOcppEngine->getOcppModel().getDiagnosticsService();
-        status = diagnosticsService->getDiagnosticsStatus();
-    } else {
-        status = DiagnosticsStatus::Idle;
-    }
+DiagnosticsStatusNotification::DiagnosticsStatusNotification() : readStatusFromModel(true) {
+
 }
 
 DiagnosticsStatusNotification::DiagnosticsStatusNotification(DiagnosticsStatus status) : status(status) {
@@ -43,6 +37,9 @@ const char *DiagnosticsStatusNotification::cstrFromStatus(DiagnosticsStatus stat
 std::unique_ptr<DynamicJsonDocument> DiagnosticsStatusNotification::createReq() {
     auto doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(1)));
     JsonObject payload = doc->to<JsonObject>();
+    if (readStatusFromModel && ocppModel && ocppModel->getDiagnosticsService()) {
+        status = ocppModel->getDiagnosticsService()->getDiagnosticsStatus();
+    }
     payload["status"] = cstrFromStatus(status);
     return doc;
 }
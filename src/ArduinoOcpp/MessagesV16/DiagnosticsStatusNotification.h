@@ -13,7 +13,8 @@ namespace Ocpp16 {
 
 class DiagnosticsStatusNotification : public OcppMessage {
 private:
-    DiagnosticsStatus status;
+    DiagnosticsStatus status = DiagnosticsStatus::Idle;
+    bool readStatusFromModel = false; //default constructor: take the current status of the DiagnosticsService
     static const char *cstrFromStatus(DiagnosticsStatus status);
 public:
     DiagnosticsStatusNotification();
@@ -3,19 +3,13 @@
 // MIT License
 
 #include <ArduinoOcpp/MessagesV16/FirmwareStatusNotification.h>
-#include <ArduinoOcpp/Core/OcppEngine.h>
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/FirmwareManagement/FirmwareService.h>
 
 using ArduinoOcpp::Ocpp16::FirmwareStatusNotification;
 
-FirmwareStatusNotification::FirmwareStatusNotification() {
-    if (defaultOcppEngine && defaultOcppEngine->getOcppModel().getFirmwareService()) {
-        auto firmwareService = defaultOcppEngine->getOcppModel().getFirmwareService();
-        status = firmwareService->getFirmwareStatus();
-    } else {
-        status = FirmwareStatus::Idle;
-    }
+FirmwareStatusNotification::FirmwareStatusNotification() : readStatusFromModel(true) {
+
 }
 
 FirmwareStatusNotification::FirmwareStatusNotification(FirmwareStatus status) : status{status} {
@@ -52,6 +46,9 @@ const char *FirmwareStatusNotification::cstrFromFwStatus(FirmwareStatus status)
 std::unique_ptr<DynamicJsonDocument> FirmwareStatusNotification::createReq() {
     auto doc = std::unique_ptr<DynamicJsonDocument>(new DynamicJsonDocument(JSON_OBJECT_SIZE(1)));
     JsonObject payload = doc->to<JsonObject>();
+    if (readStatusFromModel && ocppModel && ocppModel->getFirmwareService()) {
+        status = ocppModel->getFirmwareService()->getFirmwareStatus();
+    }
     payload["status"] = cstrFromFwStatus(status);
     return doc;
 }
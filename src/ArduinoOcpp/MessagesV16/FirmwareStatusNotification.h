@@ -14,7 +14,8 @@ namespace Ocpp16 {
 
 class FirmwareStatusNotification : public OcppMessage {
 private:
-    FirmwareStatus status;
+    FirmwareStatus status = FirmwareStatus::Idle;
+    bool readStatusFromModel = false; //default constructor: take the current status of the FirmwareService
     static const char *cstrFromFwStatus(FirmwareStatus status);
 public:
     FirmwareStatusNotification();
@@ -30,11 +30,11 @@ std::unique_ptr<DynamicJsonDocument> GetConfiguration::createConf(){
     std::vector<std::string> unknownKeys;
 
     if (keys.size() == 0){ //return all existing keys
-        configurationKeys = getAllConfigurations();
+        configurationKeys = getConfigurationStore().getAllConfigurations();
     } else { //only return keys that were searched using the "key" parameter
         configurationKeys = std::make_shared<std::vector<std::shared_ptr<AbstractConfiguration>>>();
         for (size_t i = 0; i < keys.size(); i++) {
-            std::shared_ptr<AbstractConfiguration> entry = getConfiguration(keys.at(i).c_str());
+            std::shared_ptr<AbstractConfiguration> entry = getConfigurationStore().getConfiguration(keys.at(i).c_str());
             if (entry)
                 configurationKeys->push_back(entry);
             else
@@ -32,8 +32,17 @@ public:
 
     const char* getOcppOperationType();
 
+    int getSequenceChannel() {return connectorId;}
+
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool canFreezeReq() {return false;} //transactionId is only known after StartTransaction.conf
+
+    size_t getMemoryUsage() {
+        return sizeof(MeterValues) + sampleTime.capacity() * sizeof(OcppTimestamp)
+                + (power.capacity() + energy.capacity()) * sizeof(float);
+    }
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
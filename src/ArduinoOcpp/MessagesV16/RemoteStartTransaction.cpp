@@ -8,6 +8,8 @@
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::RemoteStartTransaction;
 
 RemoteStartTransaction::RemoteStartTransaction() {
@@ -7,6 +7,8 @@
 #include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingService.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::SetChargingProfile;
 
 SetChargingProfile::SetChargingProfile() {
@@ -8,6 +8,8 @@
 #include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::StartTransaction;
 
 StartTransaction::StartTransaction(int connectorId) : connectorId(connectorId) {
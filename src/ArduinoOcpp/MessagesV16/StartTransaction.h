@@ -26,6 +26,10 @@ public:
 
     const char* getOcppOperationType();
 
+    int getSequenceChannel() {return connectorId;}
+
+    bool isDroppable() {return false;} //transaction events must reach the central system
+
     void initiate();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
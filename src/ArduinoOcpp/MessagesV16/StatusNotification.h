@@ -25,6 +25,8 @@ public:
 
     const char* getOcppOperationType();
 
+    int getSequenceChannel() {return connectorId;}
+
     void initiate();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
@@ -22,10 +22,16 @@ public:
 
     const char* getOcppOperationType();
 
+    int getSequenceChannel() {return connectorId;}
+
+    bool isDroppable() {return false;} //transaction events must reach the central system
+
     void initiate();
 
     std::unique_ptr<DynamicJsonDocument> createReq();
 
+    bool canFreezeReq() {return false;} //transactionId is only known after StartTransaction.conf
+
     void processConf(JsonObject payload);
 
     void processReq(JsonObject payload);
@@ -10,8 +10,14 @@
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using ArduinoOcpp::Ocpp16::TriggerMessage;
 
+TriggerMessage::TriggerMessage(OcppEngine& context) : context(context) {
+
+}
+
 const char* TriggerMessage::getOcppOperationType(){
     return "TriggerMessage";
 }
@@ -25,40 +31,55 @@ void TriggerMessage::processReq(JsonObject payload) {
 
     statusMessage = "Rejected";
 
-    if (!strcmp(requestedMessage, "MeterValues")) {
-        if (ocppModel && ocppModel->getMeteringService()) {
-            auto mService = ocppModel->getMeteringService();
-            if (connectorId < 0) {
-                auto nConnectors = mService->getNumConnectors();
-                for (decltype(nConnectors) i = 0; i < nConnectors; i++) {
-                    triggeredOperations.push_back(mService->takeMeterValuesNow(i));
+    OcppAction requestedAction = getOcppAction(requestedMessage);
+
+    switch (requestedAction) {
+        case OcppAction::MeterValues:
+            if (ocppModel && ocppModel->getMeteringService()) {
+                auto mService = ocppModel->getMeteringService();
+                if (connectorId < 0) {
+                    auto nConnectors = mService->getNumConnectors();
+                    for (decltype(nConnectors) i = 0; i < nConnectors; i++) {
+                        triggeredOperations.push_back(mService->takeMeterValuesNow(i));
+                    }
+                } else if (connectorId < mService->getNumConnectors()) {
+                    triggeredOperations.push_back(mService->takeMeterValuesNow(connectorId));
+                } else {
+                    errorCode = "PropertyConstraintViolation";
                 }
-            } else if (connectorId < mService->getNumConnectors()) {
-                triggeredOperations.push_back(mService->takeMeterValuesNow(connectorId));
-            } else {
-                errorCode = "PropertyConstraintViolation";
             }
-        }
-    } else if (!strcmp(requestedMessage, "StatusNotification")) {
-        if (ocppModel && ocppModel->getChargePointStatusService()) {
-            auto cpsService = ocppModel->getChargePointStatusService();
-            if (connectorId < 0) {
-                auto nConnectors = cpsService->getNumConnectors();
-                for (decltype(nConnectors) i = 0; i < nConnectors; i++) {
-                    triggeredOperations.push_back(makeOcppOperation(requestedMessage, i));
+            break;
+        case OcppAction::StatusNotification:
+            if (ocppModel && ocppModel->getChargePointStatusService()) {
+                auto cpsService = ocppModel->getChargePointStatusService();
+                if (connectorId < 0) {
+                    auto nConnectors = cpsService->getNumConnectors();
+                    for (decltype(nConnectors) i = 0; i < nConnectors; i++) {
+                        triggeredOperations.push_back(context.getOperationFactory().makeOcppOperation(requestedAction, i));
+                    }
+                } else if (connectorId < cpsService->getNumConnectors()) {
+                    triggeredOperations.push_back(context.getOperationFactory().makeOcppOperation(requestedAction, connectorId));
+                } else {
+                    errorCode = "PropertyConstraintViolation";
                 }
-            } else if (connectorId < cpsService->getNumConnectors()) {
-                triggeredOperations.push_back(makeOcppOperation(requestedMessage, connectorId));
-            } else {
-                errorCode = "PropertyConstraintViolation";
             }
-        }
-    } else {
-        auto msg = makeOcppOperation(requestedMessage, connectorId);
-        if (msg) {
-            triggeredOperations.push_back(std::move(msg));
-        } else {
+            break;
+        case OcppAction::Unknown:
             statusMessage = "NotImplemented";
+            break;
+        default: {
+            if (!context.getOperationFactory().isSupported(requestedAction)) {
+                //the factory would only create the NotImplemented fallback
+                statusMessage = "NotImplemented";
+                break;
+            }
+            auto msg = context.getOperationFactory().makeOcppOperation(requestedAction, connectorId);
+            if (msg) {
+                triggeredOperations.push_back(std::move(msg));
+            } else {
+                statusMessage = "NotImplemented";
+            }
+            break;
         }
     }
 
@@ -80,12 +101,10 @@ std::unique_ptr<DynamicJsonDocument> TriggerMessage::createConf(){
     
     payload["status"] = statusMessage;
 
-    if (defaultOcppEngine) {
-        auto op = triggeredOperations.begin();
-        while (op != triggeredOperations.end()) {
-            defaultOcppEngine->initiateOperation(std::move(triggeredOperations.front()));
-            op = triggeredOperations.erase(op);
-        }
+    auto op = triggeredOperations.begin();
+    while (op != triggeredOperations.end()) {
+        context.initiateOperation(std::move(triggeredOperations.front()));
+        op = triggeredOperations.erase(op);
     }
 
     return doc;
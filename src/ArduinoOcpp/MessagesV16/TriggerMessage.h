@@ -11,18 +11,20 @@
 
 namespace ArduinoOcpp {
 
+class OcppEngine;
 class OcppOperation;
 
 namespace Ocpp16 {
 
 class TriggerMessage : public OcppMessage {
 private:
+    OcppEngine& context;
     std::vector<std::unique_ptr<OcppOperation>> triggeredOperations;
     const char *statusMessage {nullptr};
 
     const char *errorCode = nullptr;
 public:
-    TriggerMessage() = default;
+    TriggerMessage(OcppEngine& context);
 
     const char* getOcppOperationType();
 
@@ -7,6 +7,7 @@
 
 #include <ArduinoOcpp/Core/OcppMessage.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 namespace Ocpp16 {
@@ -22,3 +22,32 @@ void ao_set_console_out(void (*console_out)(const char *msg)) {
 }
 
 #endif
+
+#ifdef AO_PLATFORM_POSIX
+
+#include <time.h>
+#include <unistd.h>
+
+unsigned long ArduinoOcpp::ao_posix_tick_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long) ts.tv_sec * 1000UL + (unsigned long) ts.tv_nsec / 1000000UL;
+}
+
+uint32_t ArduinoOcpp::ao_posix_avail_heap() {
+    //there is no fixed heap on the host. Report the available physical memory, capped to the 32-bit range of the
+    //Arduino API
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages < 0 || pageSize < 0) {
+        return UINT32_MAX;
+    }
+    unsigned long long avail = (unsigned long long) pages * (unsigned long long) pageSize;
+    return avail > UINT32_MAX ? UINT32_MAX : (uint32_t) avail;
+#else
+    return UINT32_MAX;
+#endif
+}
+
+#endif //def AO_PLATFORM_POSIX
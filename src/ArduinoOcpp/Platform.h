@@ -5,6 +5,47 @@
 #ifndef AO_PLATFORM_H
 #define AO_PLATFORM_H
 
+/*
+ * Platform selection. Arduino builds (ESP8266, ESP32) use the Arduino core. Other builds use the POSIX backend,
+ * which runs the engine natively on Linux together with AO_CUSTOM_WS
+ */
+#if !defined(AO_PLATFORM_ARDUINO) && !defined(AO_PLATFORM_POSIX)
+#if defined(ARDUINO)
+#define AO_PLATFORM_ARDUINO
+#elif defined(__unix__) || defined(__APPLE__)
+#define AO_PLATFORM_POSIX
+#else
+#error "ArduinoOcpp: unsupported platform. Define AO_PLATFORM_ARDUINO or AO_PLATFORM_POSIX"
+#endif
+#endif
+
+#ifdef AO_PLATFORM_POSIX
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+typedef bool boolean; //type of the Arduino core which the engine uses throughout
+
+namespace ArduinoOcpp {
+unsigned long ao_posix_tick_ms(); //monotonic clock
+uint32_t ao_posix_avail_heap(); //available memory of the host
+}
+
+#ifndef AO_CONSOLE_PRINTF
+#ifndef AO_CUSTOM_CONSOLE
+#define AO_CONSOLE_PRINTF(X, ...) printf(X, ##__VA_ARGS__)
+#endif
+#endif
+
+#ifndef ao_tick_ms
+#define ao_tick_ms ArduinoOcpp::ao_posix_tick_ms
+#endif
+
+#ifndef ao_avail_heap
+#define ao_avail_heap ArduinoOcpp::ao_posix_avail_heap
+#endif
+#endif //def AO_PLATFORM_POSIX
+
 #ifdef AO_CUSTOM_CONSOLE
 
 #ifndef AO_CUSTOM_CONSOLE_MAXMSGSIZE
@@ -50,6 +91,14 @@ void ao_console_out(const char *msg);
 #define ao_tick_ms millis
 #endif
 
+#ifndef AO_WAKEUP_NEVER
+#define AO_WAKEUP_NEVER ((unsigned long) -1) //return value of the nextWakeupMs() functions if there is no deadline
+#endif
+
+#ifndef AO_SAMPLER_POLL_MS
+#define AO_SAMPLER_POLL_MS 1000 //wakeup period while a routine waits for a status sampler (e.g. firmware download)
+#endif
+
 #ifndef ao_avail_heap
 #include <Arduino.h>
 #define ao_avail_heap ESP.getFreeHeap
@@ -36,247 +36,200 @@
 
 namespace ArduinoOcpp {
 
-class TBDeiniter {
-public:
-    virtual ~TBDeiniter() = default;
-};
-
-std::vector<std::unique_ptr<TBDeiniter>> toBeDeinitialized;
-
-template<class T>
-class TBDeiniterConcrete : public TBDeiniter {
-private:
-    T& obj;
-public:
-    TBDeiniterConcrete(T& obj) : obj(obj) { }
-    ~TBDeiniterConcrete() {obj = nullptr;}
-};
-
-template<class T>
-void deinit_afterwards(T& obj) {
-    toBeDeinitialized.emplace_back(std::unique_ptr<TBDeiniter>{new TBDeiniterConcrete<T>{obj}});
+OcppOperationFactory::OcppOperationFactory(OcppEngine& context) : context(context) {
+    registry.resize((size_t) OcppAction::StandardCount);
+
+    registerOperation(OcppAction::Authorize, [] (int) {
+        return new Ocpp16::Authorize("A0-00-00-00");}); //send default idTag
+    registerOperation(OcppAction::BootNotification, [] (int) {
+        return new Ocpp16::BootNotification();});
+    registerOperation(OcppAction::ChangeAvailability, [] (int) {
+        return new Ocpp16::ChangeAvailability();});
+    registerOperation(OcppAction::ChangeConfiguration, [] (int) {
+        return new Ocpp16::ChangeConfiguration();});
+    registerOperation(OcppAction::ClearCache, [] (int) {
+        return new Ocpp16::ClearCache();});
+    registerOperation(OcppAction::ClearChargingProfile, [] (int) {
+        return new Ocpp16::ClearChargingProfile();});
+    registerOperation(OcppAction::DiagnosticsStatusNotification, [] (int) {
+        return new Ocpp16::DiagnosticsStatusNotification();});
+    registerOperation(OcppAction::FirmwareStatusNotification, [] (int) {
+        return new Ocpp16::FirmwareStatusNotification();});
+    registerOperation(OcppAction::GetConfiguration, [] (int) {
+        return new Ocpp16::GetConfiguration();});
+    registerOperation(OcppAction::GetDiagnostics, [] (int) {
+        return new Ocpp16::GetDiagnostics();});
+    registerOperation(OcppAction::Heartbeat, [] (int) {
+        return new Ocpp16::Heartbeat();});
+    registerOperation(OcppAction::MeterValues, [] (int) {
+        return new Ocpp16::MeterValues();});
+    registerOperation(OcppAction::RemoteStartTransaction, [] (int) {
+        return new Ocpp16::RemoteStartTransaction();});
+    registerOperation(OcppAction::RemoteStopTransaction, [] (int) {
+        return new Ocpp16::RemoteStopTransaction();});
+    registerOperation(OcppAction::Reset, [this] (int) -> OcppMessage* {
+        auto entry = findEntry(OcppAction::Reset);
+        if (entry && (!entry->listeners || (!entry->listeners->onSendConf && !entry->listeners->onReceiveReq)))
+            AO_DBG_WARN("Reset is without effect when the sendConf and receiveReq listener is not set. Set a listener which resets your device.");
+        return new Ocpp16::Reset();});
+    registerOperation(OcppAction::SetChargingProfile, [] (int) {
+        return new Ocpp16::SetChargingProfile();});
+    registerOperation(OcppAction::StartTransaction, [] (int) {
+        return new Ocpp16::StartTransaction(1);}); //connectorId 1
+    registerOperation(OcppAction::StatusNotification, [] (int connectorId) {
+        return new Ocpp16::StatusNotification(connectorId);});
+    registerOperation(OcppAction::StopTransaction, [] (int) {
+        return new Ocpp16::StopTransaction(1);}); //connectorId 1
+    registerOperation(OcppAction::TriggerMessage, [this] (int) {
+        return new Ocpp16::TriggerMessage(this->context);});
+    registerOperation(OcppAction::UnlockConnector, [] (int) {
+        return new Ocpp16::UnlockConnector();});
+    registerOperation(OcppAction::UpdateFirmware, [] (int) {
+        return new Ocpp16::UpdateFirmware();});
 }
 
-OnReceiveReqListener onAuthorizeRequest;
-void setOnAuthorizeRequestListener(OnReceiveReqListener listener){
-    onAuthorizeRequest = listener;
-    deinit_afterwards(onAuthorizeRequest);
+void OcppOperationFactory::registerOperation(OcppAction action, std::function<OcppMessage*(int connectorId)> creator,
+            OnReceiveReqListener onReceiveReq, OnSendConfListener onSendConf) {
+    if (action == OcppAction::Unknown) {
+        AO_DBG_ERR("invalid action");
+        return;
+    }
+
+    if ((size_t) action >= registry.size()) {
+        registry.resize((size_t) action + 1);
+    }
+
+    auto& entry = registry[(size_t) action];
+    entry.creator = creator;
+    entry.listeners.reset();
+    if (onReceiveReq || onSendConf) {
+        entry.listeners = std::make_shared<OperationListeners>();
+        entry.listeners->onReceiveReq = onReceiveReq;
+        entry.listeners->onSendConf = onSendConf;
+    }
 }
 
-OnReceiveReqListener onBootNotificationRequest;
-void setOnBootNotificationRequestListener(OnReceiveReqListener listener){
-    onBootNotificationRequest = listener;
-    deinit_afterwards(onBootNotificationRequest);
+OcppOperationFactory::OperationEntry *OcppOperationFactory::findEntry(OcppAction action) {
+    if ((size_t) action >= registry.size() || !registry[(size_t) action].creator) {
+        return nullptr;
+    }
+    return &registry[(size_t) action];
 }
 
-OnReceiveReqListener onTargetValuesRequest;
-void setOnTargetValuesRequestListener(OnReceiveReqListener listener) {
-    onTargetValuesRequest = listener;
-    deinit_afterwards(onTargetValuesRequest);
+bool OcppOperationFactory::isSupported(OcppAction action) {
+    return findEntry(action) != nullptr;
 }
 
-OnReceiveReqListener onSetChargingProfileRequest;
-void setOnSetChargingProfileRequestListener(OnReceiveReqListener listener){
-    onSetChargingProfileRequest = listener;
-    deinit_afterwards(onSetChargingProfileRequest);
+void OcppOperationFactory::setOnReceiveReqListener(OcppAction action, OnReceiveReqListener onReceiveReq) {
+    if (auto entry = findEntry(action)) {
+        auto listeners = entry->listeners ? std::make_shared<OperationListeners>(*entry->listeners) : std::make_shared<OperationListeners>();
+        listeners->onReceiveReq = onReceiveReq;
+        entry->listeners = listeners; //operations which have been created already keep the previous set
+    }
 }
 
-OnReceiveReqListener onStartTransactionRequest;
-void setOnStartTransactionRequestListener(OnReceiveReqListener listener){
-    onStartTransactionRequest = listener;
-    deinit_afterwards(onStartTransactionRequest);
+void OcppOperationFactory::setOnSendConfListener(OcppAction action, OnSendConfListener onSendConf) {
+    if (auto entry = findEntry(action)) {
+        auto listeners = entry->listeners ? std::make_shared<OperationListeners>(*entry->listeners) : std::make_shared<OperationListeners>();
+        listeners->onSendConf = onSendConf;
+        entry->listeners = listeners; //operations which have been created already keep the previous set
+    }
 }
 
-OnReceiveReqListener onTriggerMessageRequest;
-void setOnTriggerMessageRequestListener(OnReceiveReqListener listener){
-    onTriggerMessageRequest = listener;
-    deinit_afterwards(onTriggerMessageRequest);
+void OcppOperationFactory::setOnAuthorizeRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::Authorize, listener);
 }
 
-OnReceiveReqListener onRemoteStartTransactionReceiveRequest;
-void setOnRemoteStartTransactionReceiveRequestListener(OnReceiveReqListener listener) {
-    onRemoteStartTransactionReceiveRequest = listener;
-    deinit_afterwards(onRemoteStartTransactionReceiveRequest);
+void OcppOperationFactory::setOnBootNotificationRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::BootNotification, listener);
 }
 
-OnSendConfListener onRemoteStartTransactionSendConf;
-void setOnRemoteStartTransactionSendConfListener(OnSendConfListener listener){
-    onRemoteStartTransactionSendConf = listener;
-    deinit_afterwards(onRemoteStartTransactionSendConf);
+void OcppOperationFactory::setOnTargetValuesRequestListener(OnReceiveReqListener) {
+    //deprecated: no operation of the library uses this listener
 }
 
-OnReceiveReqListener onRemoteStopTransactionReceiveRequest;
-void setOnRemoteStopTransactionReceiveRequestListener(OnReceiveReqListener listener){
-    onRemoteStopTransactionReceiveRequest = listener;
-    deinit_afterwards(onRemoteStopTransactionReceiveRequest);
+void OcppOperationFactory::setOnSetChargingProfileRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::SetChargingProfile, listener);
 }
 
-OnSendConfListener onRemoteStopTransactionSendConf;
-void setOnRemoteStopTransactionSendConfListener(OnSendConfListener listener){
-    onRemoteStopTransactionSendConf = listener;
-    deinit_afterwards(onRemoteStopTransactionSendConf);
+void OcppOperationFactory::setOnStartTransactionRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::StartTransaction, listener);
 }
 
-OnSendConfListener onChangeConfigurationReceiveReq;
-void setOnChangeConfigurationReceiveRequestListener(OnReceiveReqListener listener){
-    onChangeConfigurationReceiveReq = listener;
-    deinit_afterwards(onChangeConfigurationReceiveReq);
+void OcppOperationFactory::setOnTriggerMessageRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::TriggerMessage, listener);
 }
 
-OnSendConfListener onChangeConfigurationSendConf;
-void setOnChangeConfigurationSendConfListener(OnSendConfListener listener){
-    onChangeConfigurationSendConf = listener;
-    deinit_afterwards(onChangeConfigurationSendConf);
+void OcppOperationFactory::setOnRemoteStartTransactionReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::RemoteStartTransaction, listener);
 }
 
-OnSendConfListener onGetConfigurationReceiveReq;
-void setOnGetConfigurationReceiveReqListener(OnSendConfListener listener){
-    onGetConfigurationReceiveReq = listener;
-    deinit_afterwards(onGetConfigurationReceiveReq);
+void OcppOperationFactory::setOnRemoteStartTransactionSendConfListener(OnSendConfListener listener) {
+    setOnSendConfListener(OcppAction::RemoteStartTransaction, listener);
 }
 
-OnSendConfListener onGetConfigurationSendConf;
-void setOnGetConfigurationSendConfListener(OnSendConfListener listener){
-    onGetConfigurationSendConf = listener;
-    deinit_afterwards(onGetConfigurationSendConf);
+void OcppOperationFactory::setOnRemoteStopTransactionReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::RemoteStopTransaction, listener);
 }
 
-OnSendConfListener onResetReceiveReq;
-void setOnResetReceiveRequestListener(OnReceiveReqListener listener) {
-    onResetReceiveReq = listener;
-    deinit_afterwards(onResetReceiveReq);
+void OcppOperationFactory::setOnRemoteStopTransactionSendConfListener(OnSendConfListener listener) {
+    setOnSendConfListener(OcppAction::RemoteStopTransaction, listener);
 }
 
-OnSendConfListener onResetSendConf;
-void setOnResetSendConfListener(OnSendConfListener listener){
-    onResetSendConf = listener;
-    deinit_afterwards(onResetSendConf);
+void OcppOperationFactory::setOnChangeConfigurationReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::ChangeConfiguration, listener);
 }
 
-OnReceiveReqListener onUpdateFirmwareReceiveReq;
-void setOnUpdateFirmwareReceiveRequestListener(OnReceiveReqListener listener) {
-    onUpdateFirmwareReceiveReq = listener;
-    deinit_afterwards(onUpdateFirmwareReceiveReq);
+void OcppOperationFactory::setOnChangeConfigurationSendConfListener(OnSendConfListener listener) {
+    setOnSendConfListener(OcppAction::ChangeConfiguration, listener);
 }
 
-OnReceiveReqListener onMeterValuesReceiveReq;
-void setOnMeterValuesReceiveRequestListener(OnReceiveReqListener listener) {
-    onMeterValuesReceiveReq = listener;
-    deinit_afterwards(onMeterValuesReceiveReq);
+void OcppOperationFactory::setOnGetConfigurationReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::GetConfiguration, listener);
 }
 
-struct CustomOcppMessageCreatorEntry {
-    const char *messageType;
-    OcppMessageCreator creator;
-    OnReceiveReqListener onReceiveReq;
-};
-
-std::vector<CustomOcppMessageCreatorEntry> customMessagesRegistry;
-void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq) {
-    customMessagesRegistry.erase(std::remove_if(customMessagesRegistry.begin(),
-                                               customMessagesRegistry.end(),
-            [messageType](CustomOcppMessageCreatorEntry &el) {
-                return !strcmp(messageType, el.messageType);
-            }),
-        customMessagesRegistry.end());
-
-    CustomOcppMessageCreatorEntry entry;
-    entry.messageType = messageType;
-    entry.creator  = ocppMessageCreator;
-    entry.onReceiveReq = onReceiveReq;
-
-    customMessagesRegistry.push_back(entry);
+void OcppOperationFactory::setOnGetConfigurationSendConfListener(OnSendConfListener listener) {
+    setOnSendConfListener(OcppAction::GetConfiguration, listener);
 }
 
-void simpleOcppFactory_deinitialize() {
-    customMessagesRegistry.clear();
-    toBeDeinitialized.clear();
+void OcppOperationFactory::setOnResetReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::Reset, listener);
 }
 
-CustomOcppMessageCreatorEntry *makeCustomOcppMessage(const char *messageType) {
-    for (auto it = customMessagesRegistry.begin(); it != customMessagesRegistry.end(); ++it) {
-        if (!strcmp(it->messageType, messageType)) {
-            return &(*it);
-        }
-    }
-    return nullptr;
+void OcppOperationFactory::setOnResetSendConfListener(OnSendConfListener listener) {
+    setOnSendConfListener(OcppAction::Reset, listener);
 }
 
-std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& json) {
+void OcppOperationFactory::setOnUpdateFirmwareReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::UpdateFirmware, listener);
+}
+
+void OcppOperationFactory::setOnMeterValuesReceiveRequestListener(OnReceiveReqListener listener) {
+    setOnReceiveReqListener(OcppAction::MeterValues, listener);
+}
+
+void OcppOperationFactory::registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq) {
+    registerOperation(registerOcppAction(messageType), [ocppMessageCreator] (int) {
+            return ocppMessageCreator();
+        }, onReceiveReq);
+}
+
+std::unique_ptr<OcppOperation> OcppOperationFactory::makeFromJson(const JsonDocument& json) {
     const char* messageType = json[2];
     return makeOcppOperation(messageType);
 }
 
-std::unique_ptr<OcppOperation> makeOcppOperation(const char *messageType, int connectorId) {
-    auto operation = makeOcppOperation();
+std::unique_ptr<OcppOperation> OcppOperationFactory::makeOcppOperation(const char *messageType, int connectorId) {
+    return makeOcppOperation(getOcppAction(messageType), connectorId);
+}
+
+std::unique_ptr<OcppOperation> OcppOperationFactory::makeOcppOperation(OcppAction action, int connectorId) {
+    auto operation = ArduinoOcpp::makeOcppOperation();
     auto msg = std::unique_ptr<OcppMessage>{nullptr};
 
-    if (CustomOcppMessageCreatorEntry *entry = makeCustomOcppMessage(messageType)) {
-        msg = std::unique_ptr<OcppMessage>(entry->creator());
-        operation->setOnReceiveReqListener(entry->onReceiveReq);
-    } else if (!strcmp(messageType, "Authorize")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Authorize("A0-00-00-00")); //send default idTag
-        operation->setOnReceiveReqListener(onAuthorizeRequest);
-    } else if (!strcmp(messageType, "BootNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::BootNotification());
-        operation->setOnReceiveReqListener(onBootNotificationRequest);
-    } else if (!strcmp(messageType, "Heartbeat")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Heartbeat());
-    } else if (!strcmp(messageType, "MeterValues")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::MeterValues());
-        operation->setOnReceiveReqListener(onMeterValuesReceiveReq);
-    } else if (!strcmp(messageType, "SetChargingProfile")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::SetChargingProfile());
-        operation->setOnReceiveReqListener(onSetChargingProfileRequest);
-    } else if (!strcmp(messageType, "StatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StatusNotification(connectorId));
-    } else if (!strcmp(messageType, "StartTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StartTransaction(1)); //connectorId 1
-        operation->setOnReceiveReqListener(onStartTransactionRequest);
-    } else if (!strcmp(messageType, "StopTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::StopTransaction(1)); //connectorId 1
-    } else if (!strcmp(messageType, "TriggerMessage")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::TriggerMessage());
-        operation->setOnReceiveReqListener(onTriggerMessageRequest);
-    } else if (!strcmp(messageType, "RemoteStartTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::RemoteStartTransaction());
-        operation->setOnReceiveReqListener(onRemoteStartTransactionReceiveRequest);
-        operation->setOnSendConfListener(onRemoteStartTransactionSendConf);
-    } else if (!strcmp(messageType, "RemoteStopTransaction")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::RemoteStopTransaction());
-        operation->setOnReceiveReqListener(onRemoteStopTransactionReceiveRequest);
-        operation->setOnSendConfListener(onRemoteStopTransactionSendConf);
-    } else if (!strcmp(messageType, "ChangeConfiguration")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ChangeConfiguration());
-        operation->setOnReceiveReqListener(onChangeConfigurationReceiveReq);
-        operation->setOnSendConfListener(onChangeConfigurationSendConf);
-    } else if (!strcmp(messageType, "GetConfiguration")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::GetConfiguration());
-        operation->setOnReceiveReqListener(onGetConfigurationReceiveReq);
-        operation->setOnSendConfListener(onGetConfigurationSendConf);
-    } else if (!strcmp(messageType, "Reset")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::Reset());
-        if (onResetSendConf == nullptr && onResetReceiveReq == nullptr)
-            AO_DBG_WARN("Reset is without effect when the sendConf and receiveReq listener is not set. Set a listener which resets your device.");
-        operation->setOnReceiveReqListener(onResetReceiveReq);
-        operation->setOnSendConfListener(onResetSendConf);
-    } else if (!strcmp(messageType, "UpdateFirmware")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::UpdateFirmware());
-        operation->setOnReceiveReqListener(onUpdateFirmwareReceiveReq);
-    } else if (!strcmp(messageType, "FirmwareStatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::FirmwareStatusNotification());
-    } else if (!strcmp(messageType, "GetDiagnostics")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::GetDiagnostics());
-    } else if (!strcmp(messageType, "DiagnosticsStatusNotification")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::DiagnosticsStatusNotification());
-    } else if (!strcmp(messageType, "UnlockConnector")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::UnlockConnector());
-    } else if (!strcmp(messageType, "ClearChargingProfile")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ClearChargingProfile());
-    } else if (!strcmp(messageType, "ChangeAvailability")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ChangeAvailability());
-    } else if (!strcmp(messageType, "ClearCache")) {
-        msg = std::unique_ptr<OcppMessage>(new Ocpp16::ClearCache());
+    if (OperationEntry *entry = findEntry(action)) {
+        msg = std::unique_ptr<OcppMessage>(entry->creator(connectorId));
+        operation->setListeners(entry->listeners);
     } else {
         AO_DBG_WARN("Operation not supported");
         msg = std::unique_ptr<OcppMessage>(new NotImplemented());
@@ -285,7 +238,7 @@ std::unique_ptr<OcppOperation> makeOcppOperation(const char *messageType, int co
     if (msg == nullptr) {
         return nullptr;
     } else {
-        operation->setOcppMessage(std::move(msg));
+        operation->setOcppMessage(std::move(msg), action);
         return operation;
     }
 }
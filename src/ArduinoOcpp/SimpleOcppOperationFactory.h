@@ -7,22 +7,96 @@
 
 #include <ArduinoJson.h>
 #include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Core/OcppAction.h>
 #include <memory>
 #include <functional>
+#include <vector>
 
 namespace ArduinoOcpp {
 
 using OcppMessageCreator = std::function<OcppMessage*()>;
 
-std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& request);
+class OcppEngine;
+
+/*
+ * Creates the operations for incoming requests and keeps the listeners which the host application attaches to them.
+ * Each OcppEngine owns one factory, so that the listeners and custom messages of one charge point don't leak into
+ * other charge points running in the same process
+ */
+class OcppOperationFactory {
+private:
+    OcppEngine& context;
+
+    /*
+     * Built-in and custom operations are registered uniformly in one table which is indexed by the OcppAction ID.
+     * makeOcppOperation() resolves an action with a single array access
+     */
+    struct OperationEntry {
+        std::function<OcppMessage*(int connectorId)> creator; //empty if the action is not supported
+        std::shared_ptr<OperationListeners> listeners; //shared by all operations of this action. Replaced, not modified when a listener changes
+    };
+
+    std::vector<OperationEntry> registry;
+
+    OperationEntry *findEntry(OcppAction action);
+
+    void registerOperation(OcppAction action, std::function<OcppMessage*(int connectorId)> creator,
+            OnReceiveReqListener onReceiveReq = nullptr, OnSendConfListener onSendConf = nullptr);
+
+    void setOnReceiveReqListener(OcppAction action, OnReceiveReqListener onReceiveReq);
+    void setOnSendConfListener(OcppAction action, OnSendConfListener onSendConf);
+public:
+    OcppOperationFactory(OcppEngine& context);
+    OcppOperationFactory(const OcppOperationFactory& rhs) = delete;
+
+    std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& request);
+
+    std::unique_ptr<OcppOperation> makeOcppOperation(OcppAction action, int connectorId = -1);
+
+    bool isSupported(OcppAction action); //false if makeOcppOperation() would create the NotImplemented fallback
+
+    std::unique_ptr<OcppOperation> makeOcppOperation(const char *actionCode, int connectorId = -1); //interns actionCode first
+
+    /*
+     * Adds an operation or replaces an operation with the same name, including the built-in operations. messageType
+     * is registered as OcppAction (see registerOcppAction()) and must remain valid (e.g. a string literal)
+     */
+    void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq = nullptr);
+
+    void setOnAuthorizeRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnBootNotificationRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnTargetValuesRequestListener(OnReceiveReqListener); //deprecated: no operation uses this listener
+    void setOnSetChargingProfileRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnStartTransactionRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnTriggerMessageRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnRemoteStartTransactionReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnRemoteStartTransactionSendConfListener(OnSendConfListener onSendConf);
+    void setOnRemoteStopTransactionReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnRemoteStopTransactionSendConfListener(OnSendConfListener onSendConf);
+    void setOnChangeConfigurationReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnChangeConfigurationSendConfListener(OnSendConfListener onSendConf);
+    void setOnGetConfigurationReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnGetConfigurationSendConfListener(OnSendConfListener onSendConf);
+    void setOnResetReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnResetSendConfListener(OnSendConfListener onSendConf);
+    void setOnUpdateFirmwareReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+    void setOnMeterValuesReceiveRequestListener(OnReceiveReqListener onReceiveReq);
+};
 
 std::unique_ptr<OcppOperation> makeOcppOperation();
 
 std::unique_ptr<OcppOperation> makeOcppOperation(OcppMessage *msg);
 
+/*
+ * Deprecated: the free functions of the former global operation factory. They forward to the operation factory of
+ * the engine which OCPP_initialize() has created and must be called after it. Use
+ * OcppEngine::getOperationFactory() or the setters of the facade (ArduinoOcpp.h) instead
+ */
+std::unique_ptr<OcppOperation> makeFromJson(const JsonDocument& request);
+
 std::unique_ptr<OcppOperation> makeOcppOperation(const char *actionCode, int connectorId = -1);
 
-void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq = NULL);
+void registerCustomOcppMessage(const char *messageType, OcppMessageCreator ocppMessageCreator, OnReceiveReqListener onReceiveReq = nullptr);
 
 void setOnAuthorizeRequestListener(OnReceiveReqListener onReceiveReq);
 void setOnBootNotificationRequestListener(OnReceiveReqListener onReceiveReq);
@@ -43,7 +117,7 @@ void setOnResetSendConfListener(OnSendConfListener onSendConf);
 void setOnUpdateFirmwareReceiveRequestListener(OnReceiveReqListener onReceiveReq);
 void setOnMeterValuesReceiveRequestListener(OnReceiveReqListener onReceiveReq);
 
-void simpleOcppFactory_deinitialize();
+void simpleOcppFactory_deinitialize(); //no operation. The factory is destroyed together with its engine
 
 } //end namespace ArduinoOcpp
 #endif
@@ -7,8 +7,11 @@
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/Configuration.h>
 
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <algorithm>
+
 #include <memory>
 #include <string.h>
 
@@ -23,12 +26,12 @@ ChargePointStatusService::ChargePointStatusService(OcppEngine& context, unsigned
 
     
     std::shared_ptr<Configuration<int>> numberOfConnectors =
-            declareConfiguration<int>("NumberOfConnectors", numConn >= 1 ? numConn - 1 : 0, CONFIGURATION_VOLATILE, false, true, false, false);
+            context.getConfigurationStore().declareConfiguration<int>("NumberOfConnectors", numConn >= 1 ? numConn - 1 : 0, CONFIGURATION_VOLATILE, false, true, false, false);
 
     const char *fpId = "Core,RemoteTrigger";
     const char *fpIdCore = "Core";
     const char *fpIdRTrigger = "RemoteTrigger";
-    auto fProfile = declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
+    auto fProfile = context.getConfigurationStore().declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
     if (!strstr(*fProfile, fpIdCore)) {
         auto fProfilePlus = std::string(*fProfile);
         if (!fProfilePlus.empty() && fProfilePlus.back() != ',')
@@ -69,6 +72,15 @@ ConnectorStatus *ChargePointStatusService::getConnector(int connectorId) {
     return connectors.at(connectorId).get();
 }
 
+ulong ChargePointStatusService::nextWakeupMs() {
+    if (!booted) return AO_WAKEUP_NEVER;
+    ulong wakeup = AO_WAKEUP_NEVER;
+    for (auto& connector : connectors) {
+        wakeup = std::min(wakeup, connector->nextWakeupMs());
+    }
+    return wakeup;
+}
+
 void ChargePointStatusService::boot() {
     booted = true;
 }
@@ -8,6 +8,7 @@
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ConnectorStatus.h>
 
 #include <vector>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -28,6 +29,8 @@ public:
     
     void loop();
 
+    ulong nextWakeupMs();
+
     void boot();
     bool isBooted();
 
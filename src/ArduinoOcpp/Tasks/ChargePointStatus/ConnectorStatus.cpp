@@ -13,8 +13,12 @@
 #include <ArduinoOcpp/MessagesV16/StopTransaction.h>
 #include <ArduinoOcpp/MessagesV16/CiStrings.h>
 
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <algorithm>
+#include <string.h>
+
 using namespace ArduinoOcpp;
 using namespace ArduinoOcpp::Ocpp16;
 
@@ -25,22 +29,22 @@ ConnectorStatus::ConnectorStatus(OcppModel& context, int connectorId)
     char key [CONF_KEYLEN_MAX + 1] = {'\0'};
 
     snprintf(key, CONF_KEYLEN_MAX + 1, "AO_SID_CONN_%d", connectorId);
-    sIdTag = declareConfiguration<const char *>(key, "", CONFIGURATION_FN, false, false, true, false);
+    sIdTag = context.getConfigurationStore().declareConfiguration<const char *>(key, "", CONFIGURATION_FN, false, false, true, false);
 
     snprintf(key, CONF_KEYLEN_MAX + 1, "AO_TXID_CONN_%d", connectorId);
-    transactionId = declareConfiguration<int>(key, -1, CONFIGURATION_FN, false, false, true, false);
+    transactionId = context.getConfigurationStore().declareConfiguration<int>(key, -1, CONFIGURATION_FN, false, false, true, false);
 
     snprintf(key, CONF_KEYLEN_MAX + 1, "AO_AVAIL_CONN_%d", connectorId);
-    availability = declareConfiguration<int>(key, AVAILABILITY_OPERATIVE, CONFIGURATION_FN, false, false, true, false);
+    availability = context.getConfigurationStore().declareConfiguration<int>(key, AVAILABILITY_OPERATIVE, CONFIGURATION_FN, false, false, true, false);
 
-    connectionTimeOut = declareConfiguration<int>("ConnectionTimeOut", 30, CONFIGURATION_FN, true, true, true, false);
-    minimumStatusDuration = declareConfiguration<int>("MinimumStatusDuration", 0, CONFIGURATION_FN, true, true, true, false);
+    connectionTimeOut = context.getConfigurationStore().declareConfiguration<int>("ConnectionTimeOut", 30, CONFIGURATION_FN, true, true, true, false);
+    minimumStatusDuration = context.getConfigurationStore().declareConfiguration<int>("MinimumStatusDuration", 0, CONFIGURATION_FN, true, true, true, false);
 
     if (!sIdTag || !transactionId || !availability) {
         AO_DBG_ERR("Cannot declare sessionIdTag, transactionId or availability");
     }
     if (sIdTag->getBuffsize() > 0 && (*sIdTag)[0] != '\0') {
-        snprintf(idTag, min((size_t) (IDTAG_LEN_MAX + 1), sIdTag->getBuffsize()), "%s", ((const char *) *sIdTag));
+        snprintf(idTag, std::min((size_t) (IDTAG_LEN_MAX + 1), sIdTag->getBuffsize()), "%s", ((const char *) *sIdTag));
         session = true;
         connectionTimeOutTimestamp = ao_tick_ms();
         connectionTimeOutListen = true;
@@ -189,6 +193,29 @@ const char *ConnectorStatus::getErrorCode() {
     return nullptr;
 }
 
+/*
+ * Only covers the timers of this connector. Changes of the samplers are not predictable. If they change, the host
+ * application needs to call the loop function
+ */
+ulong ConnectorStatus::nextWakeupMs() {
+    ulong wakeup = AO_WAKEUP_NEVER;
+    ulong now = ao_tick_ms();
+
+    if (connectionTimeOutListen) {
+        ulong timeout = ((ulong) *connectionTimeOut) * 1000UL;
+        ulong elapsed = now - connectionTimeOutTimestamp;
+        wakeup = std::min(wakeup, elapsed >= timeout ? 0 : timeout - elapsed);
+    }
+
+    if (reportedStatus != currentStatus) {
+        ulong minDuration = *minimumStatusDuration > 0 ? ((ulong) *minimumStatusDuration) * 1000UL : 0;
+        ulong elapsed = now - t_statusTransition;
+        wakeup = std::min(wakeup, elapsed >= minDuration ? 0 : minDuration - elapsed);
+    }
+
+    return wakeup;
+}
+
 void ConnectorStatus::beginSession(const char *sessionIdTag) {
     AO_DBG_DEBUG("Begin session with idTag %s, overwriting idTag %s", sessionIdTag, idTag);
     if (!sessionIdTag || *sessionIdTag == '\0') {
@@ -278,7 +305,7 @@ void ConnectorStatus::addConnectorErrorCodeSampler(std::function<const char *()>
 }
 
 void ConnectorStatus::saveState() {
-    configuration_save();
+    context.getConfigurationStore().save();
 }
 
 void ConnectorStatus::setOnUnlockConnector(std::function<bool()> unlockConnector) {
@@ -12,6 +12,7 @@
 #include <vector>
 #include <functional>
 #include <memory>
+#include <ArduinoOcpp/Platform.h>
 
 #define AVAILABILITY_OPERATIVE 2
 #define AVAILABILITY_INOPERATIVE_SCHEDULED 1
@@ -88,6 +89,8 @@ public:
 
     OcppMessage *loop();
 
+    ulong nextWakeupMs();
+
     OcppEvseState inferenceStatus();
 
     bool ocppPermitsCharge();
@@ -7,16 +7,19 @@
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
 #include <ArduinoOcpp/MessagesV16/DiagnosticsStatusNotification.h>
 
+#include <string.h>
+
 using namespace ArduinoOcpp;
 using Ocpp16::DiagnosticsStatus;
 
 DiagnosticsService::DiagnosticsService(OcppEngine& context) : context(context) {
     const char *fpId = "FirmwareManagement";
-    auto fProfile = declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
+    auto fProfile = context.getConfigurationStore().declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
     if (!strstr(*fProfile, fpId)) {
         auto fProfilePlus = std::string(*fProfile);
         if (!fProfilePlus.empty() && fProfilePlus.back() != ',')
@@ -83,6 +86,18 @@ void DiagnosticsService::loop() {
     } //end try upload
 }
 
+ulong DiagnosticsService::nextWakeupMs() {
+    if (retries <= 0) {
+        return AO_WAKEUP_NEVER;
+    }
+
+    if (uploadIssued) {
+        return AO_SAMPLER_POLL_MS; //poll the upload status sampler and the upload timeout
+    }
+
+    return context.getOcppModel().getOcppTime().getMsUntil(nextTry);
+}
+
 //timestamps before year 2021 will be treated as "undefined"
 std::string DiagnosticsService::requestDiagnosticsUpload(const std::string &location, int retries, unsigned int retryInterval, OcppTimestamp startTime, OcppTimestamp stopTime) {
     if (onUpload == nullptr) //maybe add further plausibility checks
@@ -7,8 +7,10 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <ArduinoOcpp/Core/OcppTime.h>
 #include <ArduinoOcpp/Tasks/Diagnostics/DiagnosticsStatus.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -46,6 +48,8 @@ public:
 
     void loop();
 
+    ulong nextWakeupMs();
+
     //timestamps before year 2021 will be treated as "undefined"
     //returns empty std::string if onUpload is missing or upload cannot be scheduled for another reason
     //returns fileName of diagnostics file to be uploaded if upload has been scheduled
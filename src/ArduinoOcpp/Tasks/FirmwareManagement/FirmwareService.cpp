@@ -14,12 +14,14 @@
 #include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <string.h>
+
 using namespace ArduinoOcpp;
 using ArduinoOcpp::Ocpp16::FirmwareStatus;
 
 FirmwareService::FirmwareService(OcppEngine& context) : context(context) {
     const char *fpId = "FirmwareManagement";
-    auto fProfile = declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
+    auto fProfile = context.getConfigurationStore().declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
     if (!strstr(*fProfile, fpId)) {
         auto fProfilePlus = std::string(*fProfile);
         if (!fProfilePlus.empty() && fProfilePlus.back() != ',')
@@ -33,7 +35,7 @@ void FirmwareService::setBuildNumber(const char *buildNumber) {
     if (buildNumber == nullptr)
         return;
     this->buildNumber = buildNumber;
-    previousBuildNumber = declareConfiguration<const char*>("BUILD_NUMBER", buildNumber, CONFIGURATION_FN, false, false, true, false);
+    previousBuildNumber = context.getConfigurationStore().declareConfiguration<const char*>("BUILD_NUMBER", buildNumber, CONFIGURATION_FN, false, false, true, false);
     checkedSuccessfulFwUpdate = false; //--> CS will be notified
 }
 
@@ -201,6 +203,24 @@ void FirmwareService::loop() {
     }
 }
 
+ulong FirmwareService::nextWakeupMs() {
+    if (retries <= 0) {
+        return AO_WAKEUP_NEVER;
+    }
+
+    ulong elapsed = ao_tick_ms() - timestampTransition;
+    if (elapsed < delayTransition) {
+        return delayTransition - elapsed;
+    }
+
+    ulong untilRetreive = context.getOcppModel().getOcppTime().getMsUntil(retreiveDate);
+    if (untilRetreive > 0) {
+        return untilRetreive;
+    }
+
+    return AO_SAMPLER_POLL_MS; //update in progress. Poll the download and installation status samplers
+}
+
 void FirmwareService::scheduleFirmwareUpdate(const std::string &location, OcppTimestamp retreiveDate, int retries, unsigned int retryInterval) {
     this->location = location;
     this->retreiveDate = retreiveDate;
@@ -262,7 +282,7 @@ std::unique_ptr<OcppOperation> FirmwareService::getFirmwareStatusNotification()
         if (strncmp(buildNumber, *previousBuildNumber, buildNoSize)) {
             //new FW
             previousBuildNumber->setValue(buildNumber, strlen(buildNumber) + 1);
-            configuration_save();
+            context.getConfigurationStore().save();
 
             lastReportedStatus = FirmwareStatus::Installed;
             OcppMessage *fwNotificationMsg = new Ocpp16::FirmwareStatusNotification(lastReportedStatus);
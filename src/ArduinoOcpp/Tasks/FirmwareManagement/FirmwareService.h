@@ -11,6 +11,7 @@
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
 #include <ArduinoOcpp/Tasks/FirmwareManagement/FirmwareStatus.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -78,6 +79,8 @@ public:
 
     void loop();
 
+    ulong nextWakeupMs();
+
     void scheduleFirmwareUpdate(const std::string &location, OcppTimestamp retreiveDate, int retries = 1, unsigned int retryInterval = 0);
 
     Ocpp16::FirmwareStatus getFirmwareStatus();
@@ -12,7 +12,7 @@
 using namespace ArduinoOcpp;
 
 HeartbeatService::HeartbeatService(OcppEngine& context) : context(context) {
-    heartbeatInterval = declareConfiguration("HeartbeatInterval", 86400);
+    heartbeatInterval = context.getConfigurationStore().declareConfiguration("HeartbeatInterval", 86400);
     lastHeartbeat = ao_tick_ms();
 }
 
@@ -24,7 +24,14 @@ void HeartbeatService::loop() {
     if (now - lastHeartbeat >= hbInterval) {
         lastHeartbeat = now;
 
-        auto heartbeat = makeOcppOperation("Heartbeat");
+        auto heartbeat = context.getOperationFactory().makeOcppOperation("Heartbeat");
         context.initiateOperation(std::move(heartbeat));
     }
 }
+
+ulong HeartbeatService::nextWakeupMs() {
+    ulong hbInterval = *heartbeatInterval;
+    hbInterval *= 1000UL; //conversion s -> ms
+    ulong elapsed = ao_tick_ms() - lastHeartbeat;
+    return elapsed >= hbInterval ? 0 : hbInterval - elapsed;
+}
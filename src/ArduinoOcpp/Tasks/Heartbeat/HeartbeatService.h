@@ -7,6 +7,7 @@
 
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
 #include <memory>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -23,6 +24,8 @@ public:
     HeartbeatService(OcppEngine& context);
 
     void loop();
+
+    ulong nextWakeupMs();
 };
 
 }
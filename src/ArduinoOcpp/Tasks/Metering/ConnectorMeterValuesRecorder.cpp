@@ -19,8 +19,8 @@ ConnectorMeterValuesRecorder::ConnectorMeterValuesRecorder(OcppModel& context, i
     energy = std::vector<float>();
     power = std::vector<float>();
 
-    MeterValueSampleInterval = declareConfiguration("MeterValueSampleInterval", 60);
-    MeterValuesSampledDataMaxLength = declareConfiguration("MeterValuesSampledDataMaxLength", 4, CONFIGURATION_VOLATILE, false, true, false, false);
+    MeterValueSampleInterval = context.getConfigurationStore().declareConfiguration("MeterValueSampleInterval", 60);
+    MeterValuesSampledDataMaxLength = context.getConfigurationStore().declareConfiguration("MeterValuesSampledDataMaxLength", 4, CONFIGURATION_VOLATILE, false, true, false, false);
 }
 
 void ConnectorMeterValuesRecorder::takeSample() {
@@ -81,6 +81,17 @@ OcppMessage *ConnectorMeterValuesRecorder::loop() {
     return nullptr; //successful method completition. Currently there is no reason to send a MeterValues Msg.
 }
 
+ulong ConnectorMeterValuesRecorder::nextWakeupMs() {
+    if (*MeterValueSampleInterval < 1) {
+        return AO_WAKEUP_NEVER;
+    }
+
+    //transaction breaks are caused by the host application. Only the next sample is predictable
+    ulong sampleInterval = (ulong) (*MeterValueSampleInterval * 1000);
+    ulong elapsed = ao_tick_ms() - lastSampleTime;
+    return elapsed >= sampleInterval ? 0 : sampleInterval - elapsed;
+}
+
 OcppMessage *ConnectorMeterValuesRecorder::toMeterValues() {
     if (sampleTimestamp.size() == 0) {
         AO_DBG_DEBUG("Checking if to send MeterValues ... No");
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include <ArduinoOcpp/Core/ConfigurationKeyValue.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -51,6 +52,8 @@ public:
 
     OcppMessage *loop();
 
+    ulong nextWakeupMs();
+
     void setPowerSampler(PowerSampler powerSampler);
 
     void setEnergySampler(EnergySampler energySampler);
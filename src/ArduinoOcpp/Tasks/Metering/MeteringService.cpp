@@ -5,8 +5,11 @@
 #include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
 #include <ArduinoOcpp/Core/OcppEngine.h>
 #include <ArduinoOcpp/SimpleOcppOperationFactory.h>
+#include <ArduinoOcpp/Platform.h>
 #include <ArduinoOcpp/Debug.h>
 
+#include <algorithm>
+
 using namespace ArduinoOcpp;
 
 MeteringService::MeteringService(OcppEngine& context, int numConn)
@@ -29,6 +32,14 @@ void MeteringService::loop(){
     }
 }
 
+ulong MeteringService::nextWakeupMs() {
+    ulong wakeup = AO_WAKEUP_NEVER;
+    for (auto& connector : connectors) {
+        wakeup = std::min(wakeup, connector->nextWakeupMs());
+    }
+    return wakeup;
+}
+
 void MeteringService::setPowerSampler(int connectorId, PowerSampler ps){
     if (connectorId < 0 || connectorId >= (int) connectors.size()) {
         AO_DBG_ERR("connectorId is out of bounds");
@@ -10,6 +10,7 @@
 #include <memory>
 
 #include <ArduinoOcpp/Tasks/Metering/ConnectorMeterValuesRecorder.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -29,6 +30,8 @@ public:
 
     void loop();
 
+    ulong nextWakeupMs();
+
     void setPowerSampler(int connectorId, PowerSampler powerSampler);
 
     void setEnergySampler(int connectorId, EnergySampler energySampler);
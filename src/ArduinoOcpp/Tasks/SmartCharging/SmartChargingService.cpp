@@ -7,15 +7,10 @@
 #include <ArduinoOcpp/Core/OcppModel.h>
 #include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
 #include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/FilesystemAdapter.h>
 #include <ArduinoOcpp/Debug.h>
 
-#if defined(ESP32) && !defined(AO_DEACTIVATE_FLASH)
-#include <LITTLEFS.h>
-#define USE_FS LITTLEFS
-#else
-#include <FS.h>
-#define USE_FS SPIFFS
-#endif
+#include <string.h>
 
 #define SINGLE_CONNECTOR_ID 1
 
@@ -43,10 +38,10 @@ SmartChargingService::SmartChargingService(OcppEngine& context, float chargeLimi
         TxDefaultProfile[i] = NULL;
         TxProfile[i] = NULL;
     }
-    declareConfiguration<int>("ChargeProfileMaxStackLevel", CHARGEPROFILEMAXSTACKLEVEL, CONFIGURATION_VOLATILE, false, true, false, false);
+    context.getConfigurationStore().declareConfiguration<int>("ChargeProfileMaxStackLevel", CHARGEPROFILEMAXSTACKLEVEL, CONFIGURATION_VOLATILE, false, true, false, false);
 
     const char *fpId = "SmartCharging";
-    auto fProfile = declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
+    auto fProfile = context.getConfigurationStore().declareConfiguration<const char*>("SupportedFeatureProfiles",fpId, CONFIGURATION_VOLATILE, false, true, true, false);
     if (!strstr(*fProfile, fpId)) {
         auto fProfilePlus = std::string(*fProfile);
         if (!fProfilePlus.empty() && fProfilePlus.back() != ',')
@@ -98,6 +93,10 @@ float SmartChargingService::inferenceLimitNow(){
     return limit;
 }
 
+ulong SmartChargingService::nextWakeupMs() {
+    return context.getOcppModel().getOcppTime().getMsUntil(nextChange);
+}
+
 void SmartChargingService::setOnLimitChange(OnLimitChange onLtChg){
     onLimitChange = onLtChg;
 }
@@ -319,8 +318,9 @@ bool SmartChargingService::clearChargingProfile(const std::function<bool(int, in
                             break;
                     }
 
-                    if (USE_FS.exists(fn)) {
-                        USE_FS.remove(fn);
+                    auto filesystem = getFilesystemAdapter();
+                    if (filesystem && filesystem->exists(fn)) {
+                        filesystem->remove(fn);
                     }
                 } else {
                     AO_DBG_DEBUG("Prohibit access to FS");
@@ -362,11 +362,17 @@ bool SmartChargingService::writeProfileToFlash(JsonObject *json, ChargingProfile
             break;
     }
 
-    if (USE_FS.exists(fn)) {
-        USE_FS.remove(fn);
+    auto filesystem = getFilesystemAdapter();
+    if (!filesystem) {
+        AO_DBG_ERR("Unable to save: no filesystem");
+        return false;
     }
 
-    File file = USE_FS.open(fn, "w");
+    if (filesystem->exists(fn)) {
+        filesystem->remove(fn);
+    }
+
+    auto file = filesystem->open(fn, "w");
 
     if (!file) {
         AO_DBG_ERR("Unable to save: could not save profile: %s", fn);
@@ -374,14 +380,13 @@ bool SmartChargingService::writeProfileToFlash(JsonObject *json, ChargingProfile
     }
 
     // Serialize JSON to file
-    if (serializeJson(*json, file) == 0) {
+    if (serializeJson(*json, *file) == 0) {
         AO_DBG_ERR("Unable to save: could not serialize JSON for profile: %s", fn);
-        file.close();
         return false;
     }
 
     //success
-    file.close();
+    file.reset(); //close
 
     AO_DBG_DEBUG("Saving profile successful");
 
@@ -399,6 +404,12 @@ bool SmartChargingService::loadProfiles() {
         return true;
     }
 
+    auto filesystem = getFilesystemAdapter();
+    if (!filesystem) {
+        AO_DBG_ERR("Unable to initialize: no filesystem");
+        return false;
+    }
+
     ChargingProfilePurposeType purposes[] = {ChargingProfilePurposeType::ChargePointMaxProfile, ChargingProfilePurposeType::TxDefaultProfile, ChargingProfilePurposeType::TxProfile};
 
     char fn [PROFILE_FN_MAXSIZE] = {'\0'};
@@ -419,11 +430,11 @@ bool SmartChargingService::loadProfiles() {
                     break;
             }
 
-            if (!USE_FS.exists(fn)) {
+            if (!filesystem->exists(fn)) {
                 continue; //There is not a profile on the stack iStack with stacklevel iLevel. Normal case, just continue.
             }
             
-            File file = USE_FS.open(fn, "r");
+            auto file = filesystem->open(fn, "r");
 
             if (file) {
                 AO_DBG_DEBUG("Load profile from file: %s", fn);
@@ -433,14 +444,7 @@ bool SmartChargingService::loadProfiles() {
                 continue;
             }
 
-            if (!file.available()) {
-                AO_DBG_ERR("Unable to initialize: empty file for profile: %s", fn);
-                file.close();
-                success = false;
-                continue;
-            }
-
-            int file_size = file.size();
+            size_t file_size = file->size();
 
             if (file_size < 2) {
                 AO_DBG_ERR("Unable to initialize: too short for json: %s", fn);
@@ -460,7 +464,7 @@ bool SmartChargingService::loadProfiles() {
 
                 DynamicJsonDocument profileDoc(capacity);
 
-                DeserializationError jsonError = deserializeJson(profileDoc, file);
+                DeserializationError jsonError = deserializeJson(profileDoc, *file);
                 switch (jsonError.code()) {
                     case DeserializationError::Ok:
                         error = false;
@@ -486,7 +490,7 @@ bool SmartChargingService::loadProfiles() {
                 if (increaseCapacity) {
                     capacity *= 3;
                     capacity /= 2;
-                    file.seek(0, SeekSet); //rewind file to beginning
+                    file->seek(0); //rewind file to beginning
                     AO_DBG_DEBUG("Initialization: increase JsonCapacity to %zu for file: %s", capacity, fn);
                     continue;
                 }
@@ -497,8 +501,6 @@ bool SmartChargingService::loadProfiles() {
                 profileDoc.clear();
                 break;
             }
-
-            file.close();
         }
     }
 
@@ -13,6 +13,7 @@
 #include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingModel.h>
 #include <ArduinoOcpp/Core/ConfigurationOptions.h>
 #include <ArduinoOcpp/Core/OcppTime.h>
+#include <ArduinoOcpp/Platform.h>
 
 namespace ArduinoOcpp {
 
@@ -50,6 +51,8 @@ public:
     void setOnLimitChange(OnLimitChange onLimitChange);
     ChargingSchedule *getCompositeSchedule(int connectorId, otime_t duration);
     void loop();
+
+    ulong nextWakeupMs();
 };
 
 } //end namespace ArduinoOcpp
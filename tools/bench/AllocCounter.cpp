@@ -0,0 +1,86 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include "AllocCounter.h"
+
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+}
+
+namespace {
+
+uint64_t allocations = 0;
+size_t liveBytes = 0;
+size_t peakBytes = 0;
+
+void onAlloc(void *ptr) {
+    if (ptr) {
+        allocations++;
+        liveBytes += malloc_usable_size(ptr);
+        if (liveBytes > peakBytes) {
+            peakBytes = liveBytes;
+        }
+    }
+}
+
+void onFree(void *ptr) {
+    if (ptr) {
+        liveBytes -= malloc_usable_size(ptr);
+    }
+}
+
+} //end anonymous namespace
+
+extern "C" {
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    onAlloc(ptr);
+    return ptr;
+}
+
+void *calloc(size_t n, size_t size) {
+    void *ptr = __libc_calloc(n, size);
+    onAlloc(ptr);
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    onFree(ptr);
+    void *res = __libc_realloc(ptr, size);
+    if (res) {
+        onAlloc(res);
+    } else if (ptr && size) {
+        liveBytes += malloc_usable_size(ptr); //realloc failed; ptr is still valid
+    }
+    return res;
+}
+
+void free(void *ptr) {
+    onFree(ptr);
+    __libc_free(ptr);
+}
+
+} //extern "C"
+
+namespace AllocCounter {
+
+Snapshot get() {
+    Snapshot snapshot;
+    snapshot.allocations = allocations;
+    snapshot.liveBytes = liveBytes;
+    snapshot.peakBytes = peakBytes;
+    return snapshot;
+}
+
+void resetPeak() {
+    peakBytes = liveBytes;
+}
+
+} //end namespace AllocCounter
@@ -0,0 +1,28 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Heap accounting of the benchmark binary. AllocCounter.cpp replaces malloc() and friends (glibc only), so that the
+ * counters cover operator new as well as the DynamicJsonDocument pools, which ArduinoJson takes from malloc()
+ */
+namespace AllocCounter {
+
+struct Snapshot {
+    uint64_t allocations; //number of successful malloc / calloc / realloc calls
+    size_t liveBytes; //currently allocated
+    size_t peakBytes; //max of liveBytes since the last resetPeak()
+};
+
+Snapshot get();
+void resetPeak(); //sets peakBytes to the current liveBytes
+
+} //end namespace AllocCounter
+
+#endif
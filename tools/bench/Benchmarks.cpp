@@ -0,0 +1,474 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+/*
+ * Microbenchmarks of the JSON hot paths of the engine. Each benchmark reports the mean time per operation, the heap
+ * allocations per operation and the peak heap usage above the level before the benchmark.
+ * 
+ * Build and run on the host:
+ * 
+ *     pio run -e bench
+ *     .pio/build/bench/program [filter]
+ * 
+ * With a filter, only the benchmarks whose name contains the filter string are run
+ */
+
+#include "AllocCounter.h"
+
+#include <ArduinoOcpp/Core/OcppConnection.h>
+#include <ArduinoOcpp/Core/OcppEngine.h>
+#include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Core/OcppSocket.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+#include <ArduinoOcpp/Core/ObjectPool.h>
+#include <ArduinoOcpp/SimpleOcppOperationFactory.h>
+#include <ArduinoOcpp/MessagesV16/BootNotification.h>
+#include <ArduinoOcpp/MessagesV16/ChangeConfiguration.h>
+#include <ArduinoOcpp/MessagesV16/GetConfiguration.h>
+#include <ArduinoOcpp/MessagesV16/Heartbeat.h>
+#include <ArduinoOcpp/MessagesV16/MeterValues.h>
+#include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
+#include <ArduinoOcpp/Tasks/Heartbeat/HeartbeatService.h>
+#include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
+#include <ArduinoOcpp/Tasks/SmartCharging/SmartChargingService.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace ArduinoOcpp;
+
+#define BENCH_MIN_ITERATIONS 100
+#define BENCH_MIN_DURATION_NS 200000000ULL //run each benchmark for at least 200 ms
+#define BENCH_FRAME_MAXLEN 1024
+#define BENCH_FRAME_VARIANTS 16 //more than AO_CONF_CACHE_SIZE, so that the message IDs are never answered from the cache
+#define BENCH_MATCH_QUEUE_DEPTH 1000 //pending operations while CALLRESULTs are matched
+#define BENCH_LOOP_QUEUE_DEPTH 500 //pending operations while the loop is measured
+
+namespace {
+
+uint64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * Socket which keeps the last outgoing frame and lets the benchmarks inject incoming frames
+ */
+class BenchSocket : public OcppSocket {
+private:
+    ReceiveTXTcallback receiveTXT;
+    ReceiveBINcallback receiveBIN;
+public:
+    std::string lastSent;
+
+    void loop() { }
+
+    bool sendTXT(std::string &out) {
+        lastSent.swap(out);
+        return true;
+    }
+
+    bool sendBIN(const uint8_t *payload, size_t len) {
+        lastSent.assign((const char*) payload, len);
+        return true;
+    }
+
+    void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) {this->receiveTXT = receiveTXT;}
+
+    void setReceiveBINcallback(ReceiveBINcallback &receiveBIN) {this->receiveBIN = receiveBIN;}
+
+    bool receive(const char *frame, size_t len) {
+        return receiveTXT(frame, len);
+    }
+
+    bool receiveBinary(const std::string& frame) {
+        return receiveBIN((const uint8_t*) frame.data(), frame.length());
+    }
+};
+
+const char *filter = nullptr;
+
+void runBenchmark(const char *name, std::function<void()> op) {
+    if (filter && !strstr(name, filter)) {
+        return;
+    }
+
+    op(); //warm up caches and lazily initialized buffers
+
+    AllocCounter::resetPeak();
+    AllocCounter::Snapshot before = AllocCounter::get();
+
+    uint64_t iterations = 0;
+    uint64_t start = nowNs();
+    uint64_t elapsed = 0;
+    do {
+        for (int i = 0; i < BENCH_MIN_ITERATIONS; i++) {
+            op();
+        }
+        iterations += BENCH_MIN_ITERATIONS;
+        elapsed = nowNs() - start;
+    } while (elapsed < BENCH_MIN_DURATION_NS);
+
+    AllocCounter::Snapshot after = AllocCounter::get();
+
+    printf("%-52s %12.0f %12.1f %12zu\n", name,
+            (double) elapsed / (double) iterations,
+            (double) (after.allocations - before.allocations) / (double) iterations,
+            after.peakBytes - before.liveBytes);
+}
+
+/*
+ * Feeds a CALL into the connection and lets the engine send the response. frameFmt contains one %u for the
+ * message ID, because the connection answers repeated message IDs from its cache
+ */
+void runInboundCall(const char *name, OcppEngine& engine, BenchSocket& socket, const char *frameFmt) {
+    unsigned int msgId = 0;
+    char frame [BENCH_FRAME_MAXLEN];
+    runBenchmark(name, [&] () {
+        int len = snprintf(frame, sizeof(frame), frameFmt, ++msgId);
+        socket.receive(frame, (size_t) len);
+        engine.loop();
+    });
+}
+
+/*
+ * Feeds the same CALL as JSON text and as MessagePack frame into the connection, including the response. The frames
+ * are prepared in advance with different message IDs, so that only the engine is measured. frameFmt is as in
+ * runInboundCall()
+ */
+void runInboundFraming(const char *name, OcppEngine& engine, BenchSocket& socket, const char *frameFmt) {
+    std::vector<std::string> txtFrames, binFrames;
+    size_t txtBytes = 0, binBytes = 0;
+    for (unsigned int i = 0; i < BENCH_FRAME_VARIANTS; i++) {
+        char frame [BENCH_FRAME_MAXLEN];
+        int len = snprintf(frame, sizeof(frame), frameFmt, 900000U + i);
+        txtFrames.push_back(std::string(frame, (size_t) len));
+
+        DynamicJsonDocument doc (BENCH_FRAME_MAXLEN);
+        deserializeJson(doc, frame, (size_t) len);
+        std::string bin;
+        serializeMsgPack(doc, bin);
+        binFrames.push_back(bin);
+
+        txtBytes = txtFrames.back().length();
+        binBytes = binFrames.back().length();
+    }
+
+    char label [96];
+    size_t i = 0;
+    snprintf(label, sizeof(label), "%s, text (%zu B)", name, txtBytes);
+    runBenchmark(label, [&] () {
+        const std::string& frame = txtFrames[i++ % BENCH_FRAME_VARIANTS];
+        socket.receive(frame.c_str(), frame.length());
+        engine.loop();
+    });
+
+    snprintf(label, sizeof(label), "%s, MessagePack (%zu B)", name, binBytes);
+    runBenchmark(label, [&] () {
+        socket.receiveBinary(binFrames[i++ % BENCH_FRAME_VARIANTS]);
+        engine.loop();
+    });
+}
+
+/*
+ * The parse step of processOcppSocketInputTXT, before and after the parse arena. Before, every frame got a new
+ * document of length + 100 bytes, which was replaced by a 1.5 times bigger one and parsed again on NoMemory. The
+ * allocations and peak bytes show the heap churn which the arena removes
+ */
+void runParse(const char *name, const std::string& frame) {
+    char label [96];
+    snprintf(label, sizeof(label), "%s, per-message document", name);
+    runBenchmark(label, [&frame] () {
+        std::unique_ptr<DynamicJsonDocument> doc;
+        size_t capacity = frame.length() + 100;
+        DeserializationError err = DeserializationError::NoMemory;
+        while (err == DeserializationError::NoMemory && capacity <= AO_PARSE_ARENA_SIZE * 4) {
+            doc.reset(new DynamicJsonDocument(capacity));
+            err = deserializeJson(*doc, frame.c_str(), frame.length());
+            capacity /= 2;
+            capacity *= 3;
+        }
+    });
+
+    DynamicJsonDocument parseArena {AO_PARSE_ARENA_SIZE};
+    snprintf(label, sizeof(label), "%s, parse arena", name);
+    runBenchmark(label, [&frame, &parseArena] () {
+        deserializeJson(parseArena, frame.c_str(), frame.length());
+    });
+}
+
+/*
+ * Queues Heartbeats in the connection until depth operations are pending. The numeric message IDs of the queued
+ * operations are appended to msgIds in queue order. The queue budget must be unlimited, otherwise operations
+ * could be dropped while msgIds still refers to them
+ */
+void fillQueue(OcppEngine& engine, std::deque<int>& msgIds, size_t depth) {
+    while (msgIds.size() < depth) {
+        auto op = makeOcppOperation(new Ocpp16::Heartbeat());
+        OcppOperation *queued = op.get();
+        engine.initiateOperation(std::move(op));
+        msgIds.push_back(queued->getMessageIdNum());
+    }
+}
+
+/*
+ * Feeds the CALLRESULT for the queued operation with the numeric message ID msgId into the connection
+ */
+void answerOperation(BenchSocket& socket, int msgId) {
+    char conf [BENCH_FRAME_MAXLEN];
+    int len = snprintf(conf, sizeof(conf), "[3,\"%i\",{\"currentTime\":\"2022-06-01T12:00:00.000Z\"}]", msgId);
+    socket.receive(conf, (size_t) len);
+}
+
+void drainQueue(BenchSocket& socket, std::deque<int>& msgIds) {
+    while (!msgIds.empty()) {
+        answerOperation(socket, msgIds.front());
+        msgIds.pop_front();
+    }
+}
+
+} //end anonymous namespace
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        filter = argv[1];
+    }
+
+    configuration_init(FilesystemOpt::Deactivate);
+
+    BenchSocket socket;
+    OcppEngine engine {socket, Clocks::DEFAULT_CLOCK};
+    auto& model = engine.getOcppModel();
+    model.setChargePointStatusService(std::unique_ptr<ChargePointStatusService>(
+        new ChargePointStatusService(engine, 2)));
+    model.setHeartbeatService(std::unique_ptr<HeartbeatService>(
+        new HeartbeatService(engine)));
+    model.setMeteringSerivce(std::unique_ptr<MeteringService>(
+        new MeteringService(engine, 2)));
+    model.setSmartChargingService(std::unique_ptr<SmartChargingService>(
+        new SmartChargingService(engine, 11000.f, 230.f, 2, FilesystemOpt::Deactivate)));
+    engine.setRunOcppTasks(false); //only the connection runs; no StatusNotifications or MeterValues in between
+
+    printf("%-52s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op", "peak bytes");
+
+    /*
+     * MeterValues::createReq
+     */
+    for (size_t nSamples : {1, 10, 100, 1000}) {
+        std::vector<OcppTimestamp> sampleTime;
+        std::vector<float> energy, power;
+        for (size_t i = 0; i < nSamples; i++) {
+            sampleTime.push_back(OcppTimestamp(2022, 5, 1, 12, (int32_t) (i / 60) % 60, (int32_t) i % 60));
+            energy.push_back(1000.f + 3.0556f * i);
+            power.push_back(11000.f);
+        }
+        Ocpp16::MeterValues meterValues {&sampleTime, &energy, &power, 1, 42};
+
+        char name [64];
+        snprintf(name, sizeof(name), "MeterValues::createReq (%zu samples)", nSamples);
+        runBenchmark(name, [&meterValues] () {
+            auto doc = meterValues.createReq();
+        });
+    }
+
+    /*
+     * processOcppSocketInputTXT with representative inbound frames, including the response
+     */
+    runInboundCall("processOcppSocketInputTXT ClearCache", engine, socket,
+            "[2,\"%u\",\"ClearCache\",{}]");
+    runInboundCall("processOcppSocketInputTXT GetConfiguration (1 key)", engine, socket,
+            "[2,\"%u\",\"GetConfiguration\",{\"key\":[\"HeartbeatInterval\"]}]");
+    runInboundCall("processOcppSocketInputTXT ChangeConfiguration", engine, socket,
+            "[2,\"%u\",\"ChangeConfiguration\",{\"key\":\"MeterValueSampleInterval\",\"value\":\"30\"}]");
+
+    /*
+     * Parsing inbound frames with and without the parse arena
+     */
+    for (size_t nPeriods : {3, 48}) {
+        std::string frame = "[2,\"1\",\"SetChargingProfile\",{\"connectorId\":1,\"csChargingProfiles\":{"
+                "\"chargingProfileId\":1,\"stackLevel\":0,\"chargingProfilePurpose\":\"TxDefaultProfile\","
+                "\"chargingProfileKind\":\"Absolute\",\"chargingSchedule\":{"
+                "\"startSchedule\":\"2022-06-01T12:00:00.000Z\",\"chargingRateUnit\":\"W\","
+                "\"chargingSchedulePeriod\":[";
+        for (size_t i = 0; i < nPeriods; i++) {
+            char period [64];
+            snprintf(period, sizeof(period), "%s{\"startPeriod\":%zu,\"limit\":%zu}", i ? "," : "", i * 1800, 11000 - i * 100);
+            frame += period;
+        }
+        frame += "]}}}]";
+
+        char name [64];
+        snprintf(name, sizeof(name), "parse SetChargingProfile (%zu periods)", nPeriods);
+        runParse(name, frame);
+    }
+
+    {
+        char conf [BENCH_FRAME_MAXLEN];
+        runBenchmark("Heartbeat round trip (sendReq + CALLRESULT)", [&] () {
+            engine.initiateOperation(makeOcppOperation(new Ocpp16::Heartbeat()));
+            engine.loop();
+            const char *idBegin = strchr(socket.lastSent.c_str(), '"');
+            const char *idEnd = idBegin ? strchr(idBegin + 1, '"') : nullptr;
+            if (!idEnd) {
+                return;
+            }
+            int len = snprintf(conf, sizeof(conf), "[3,%.*s,{\"currentTime\":\"2022-06-01T12:00:00.000Z\"}]",
+                    (int) (idEnd - idBegin + 1), idBegin);
+            socket.receive(conf, (size_t) len);
+            engine.loop();
+        });
+    }
+
+    /*
+     * Deep outbound queue, e.g. after an outage. The queue budget is lifted for these benchmarks
+     */
+    auto initiatedOpsMax = engine.getConfigurationStore().declareConfiguration<int>("AO_INITIATED_OPS_MAX", AO_INITIATED_OPS_MAX, CONFIGURATION_FN, true, true, true, false);
+    auto initiatedOpsBytes = engine.getConfigurationStore().declareConfiguration<int>("AO_INITIATED_OPS_BYTES", AO_INITIATED_OPS_BYTES, CONFIGURATION_FN, true, true, true, false);
+    *initiatedOpsMax = 0; //unlimited
+    *initiatedOpsBytes = 0;
+
+    {
+        std::deque<int> msgIds;
+        fillQueue(engine, msgIds, BENCH_MATCH_QUEUE_DEPTH);
+
+        char name [64];
+        snprintf(name, sizeof(name), "CALLRESULT matching (%u queued operations)", BENCH_MATCH_QUEUE_DEPTH);
+        runBenchmark(name, [&] () {
+            answerOperation(socket, msgIds.back()); //the newest operation, i.e. the worst case of a linear search
+            msgIds.pop_back();
+            fillQueue(engine, msgIds, BENCH_MATCH_QUEUE_DEPTH);
+        });
+
+        drainQueue(socket, msgIds);
+    }
+
+    {
+        std::deque<int> msgIds;
+        fillQueue(engine, msgIds, BENCH_LOOP_QUEUE_DEPTH);
+        engine.loop(); //send the first operation and tick the timeouts of the others
+
+        char name [64];
+        snprintf(name, sizeof(name), "OcppEngine::loop (%u queued operations)", BENCH_LOOP_QUEUE_DEPTH);
+        runBenchmark(name, [&engine] () {
+            engine.loop(); //no retry or timeout is due within the measurement
+        });
+
+        drainQueue(socket, msgIds);
+    }
+
+    *initiatedOpsMax = AO_INITIATED_OPS_MAX;
+    *initiatedOpsBytes = AO_INITIATED_OPS_BYTES;
+
+    /*
+     * GetConfiguration::createConf with every key
+     */
+    {
+        StaticJsonDocument<JSON_OBJECT_SIZE(1)> emptyReq;
+        JsonObject emptyPayload = emptyReq.to<JsonObject>();
+        Ocpp16::GetConfiguration getConfiguration;
+        getConfiguration.processReq(emptyPayload);
+
+        char name [64];
+        snprintf(name, sizeof(name), "GetConfiguration::createConf (%zu keys)",
+                getDefaultConfigurationStore()->getAllConfigurations()->size());
+        runBenchmark(name, [&getConfiguration] () {
+            auto doc = getConfiguration.createConf();
+        });
+    }
+
+    /*
+     * ChangeConfiguration::processReq
+     */
+    {
+        StaticJsonDocument<256> req;
+        deserializeJson(req, "{\"key\":\"HeartbeatInterval\",\"value\":\"3600\"}");
+        JsonObject payload = req.as<JsonObject>();
+        runBenchmark("ChangeConfiguration::processReq", [&payload] () {
+            Ocpp16::ChangeConfiguration changeConfiguration;
+            changeConfiguration.processReq(payload);
+        });
+    }
+
+    /*
+     * SetChargingProfile ingestion through the connection
+     */
+    runInboundCall("SetChargingProfile ingestion (3 periods)", engine, socket,
+            "[2,\"%u\",\"SetChargingProfile\",{\"connectorId\":1,\"csChargingProfiles\":{"
+                "\"chargingProfileId\":1,\"stackLevel\":0,\"chargingProfilePurpose\":\"TxDefaultProfile\","
+                "\"chargingProfileKind\":\"Absolute\",\"chargingSchedule\":{"
+                "\"startSchedule\":\"2022-06-01T12:00:00.000Z\",\"chargingRateUnit\":\"W\","
+                "\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":11000},"
+                "{\"startPeriod\":3600,\"limit\":7400},{\"startPeriod\":7200,\"limit\":3700}]}}}]");
+
+    /*
+     * OcppOperation::sendReq framing
+     */
+    int benchMsgIdNum = 1000000; //message IDs of the operations which are sent without connection
+    runBenchmark("OcppOperation::sendReq BootNotification", [&socket, &benchMsgIdNum] () {
+        auto op = makeOcppOperation(new Ocpp16::BootNotification("Bench Model", "Bench Vendor"));
+        op->setInitiated(benchMsgIdNum++);
+        op->sendReq(socket);
+    });
+
+    /*
+     * JSON text framing vs. MessagePack framing. The connection accepts binary frames from here on and answers
+     * binary requests with binary confs
+     */
+    auto framing = engine.getConfigurationStore().declareConfiguration<int>("AO_FRAMING", 0, CONFIGURATION_FN, false, false, true, false);
+    if (framing) {
+        *framing = (int) FramingMode::Accept;
+    }
+
+    {
+        std::vector<OcppTimestamp> sampleTime;
+        std::vector<float> energy, power;
+        for (size_t i = 0; i < 10; i++) {
+            sampleTime.push_back(OcppTimestamp(2022, 5, 1, 12, 0, (int32_t) i));
+            energy.push_back(1000.f + 3.0556f * i);
+            power.push_back(11000.f);
+        }
+
+        for (bool binary : {false, true}) {
+            size_t frameLen = 0;
+            char name [96];
+            snprintf(name, sizeof(name), "OcppOperation::sendReq MeterValues (10 samples), %s",
+                    binary ? "MessagePack" : "text");
+            runBenchmark(name, [&] () {
+                auto op = makeOcppOperation(new Ocpp16::MeterValues(&sampleTime, &energy, &power, 1, 42));
+                op->setInitiated(benchMsgIdNum++);
+                op->setBinaryFraming(binary);
+                op->sendReq(socket);
+                frameLen = socket.lastSent.length();
+            });
+            printf("%-52s %12zu B\n", "    frame size", frameLen);
+        }
+    }
+
+    runInboundFraming("inbound GetConfiguration (1 key)", engine, socket,
+            "[2,\"%u\",\"GetConfiguration\",{\"key\":[\"HeartbeatInterval\"]}]");
+    runInboundFraming("inbound SetChargingProfile (3 periods)", engine, socket,
+            "[2,\"%u\",\"SetChargingProfile\",{\"connectorId\":1,\"csChargingProfiles\":{"
+                "\"chargingProfileId\":1,\"stackLevel\":0,\"chargingProfilePurpose\":\"TxDefaultProfile\","
+                "\"chargingProfileKind\":\"Absolute\",\"chargingSchedule\":{"
+                "\"startSchedule\":\"2022-06-01T12:00:00.000Z\",\"chargingRateUnit\":\"W\","
+                "\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":11000},"
+                "{\"startPeriod\":3600,\"limit\":7400},{\"startPeriod\":7200,\"limit\":3700}]}}}]");
+
+    printf("\n");
+    printf("%-52s %12zu B\n", "sizeof(OcppOperation)", sizeof(OcppOperation));
+    printf("%-52s %12zu B\n", "sizeof(OfflineSensitiveTimeout)", sizeof(OfflineSensitiveTimeout));
+    printf("%-52s %12zu B\n", "sizeof(OperationListeners) (shared, only if set)", sizeof(OperationListeners));
+    printf("\n");
+    Pools::dump(); //operations and messages above come from the pools and don't count as heap allocations
+
+    return 0;
+}
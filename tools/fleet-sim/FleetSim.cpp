@@ -0,0 +1,144 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+/*
+ * Fleet load generator: runs N simulated charge points, each on its own OcppEngine, against an in-process stand-in
+ * CSMS and reports the message rate, the round-trip latency per action and the engine CPU time per charge point.
+ * 
+ * Build and run on the host:
+ * 
+ *     pio run -e fleet_sim
+ *     .pio/build/fleet_sim/program --chargers 1000 --duration 120
+ * 
+ * Options (times in seconds unless noted otherwise):
+ *     --chargers N       number of charge points (default 100)
+ *     --duration S       run time (default 60)
+ *     --idle S           time between unplug and the next plug-in (default 20)
+ *     --charge S         duration of a charging session (default 30)
+ *     --meter-interval S MeterValueSampleInterval of the charge points (default 10)
+ *     --heartbeat S      heartbeat interval assigned by the CSMS (default 30)
+ *     --delay MS         response delay of the CSMS in milliseconds (default 5)
+ */
+
+#include "FleetStats.h"
+#include "SimCharger.h"
+#include "StandInCsms.h"
+
+#include <ArduinoOcpp/Platform.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace FleetSim;
+
+#define SIM_MAX_SLEEP_MS 10UL
+#define SIM_PROGRESS_INTERVAL_S 10
+
+int main(int argc, char **argv) {
+    int nChargers = 100;
+    int durationS = 60;
+    int heartbeatS = 30;
+    unsigned long delayMs = 5;
+    CycleScript script {20000UL, 30000UL, 10};
+
+    static struct option longOpts [] = {
+        {"chargers", required_argument, nullptr, 'n'},
+        {"duration", required_argument, nullptr, 't'},
+        {"idle", required_argument, nullptr, 'i'},
+        {"charge", required_argument, nullptr, 'c'},
+        {"meter-interval", required_argument, nullptr, 'm'},
+        {"heartbeat", required_argument, nullptr, 'h'},
+        {"delay", required_argument, nullptr, 'd'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:t:i:c:m:h:d:", longOpts, nullptr)) != -1) {
+        switch (opt) {
+            case 'n': nChargers = atoi(optarg); break;
+            case 't': durationS = atoi(optarg); break;
+            case 'i': script.idleMs = strtoul(optarg, nullptr, 10) * 1000UL; break;
+            case 'c': script.chargeMs = strtoul(optarg, nullptr, 10) * 1000UL; break;
+            case 'm': script.meterValueSampleInterval = atoi(optarg); break;
+            case 'h': heartbeatS = atoi(optarg); break;
+            case 'd': delayMs = strtoul(optarg, nullptr, 10); break;
+            default:
+                fprintf(stderr, "see the header of FleetSim.cpp for the options\n");
+                return 1;
+        }
+    }
+
+    if (nChargers <= 0 || durationS <= 0) {
+        fprintf(stderr, "chargers and duration must be positive\n");
+        return 1;
+    }
+
+    FleetStats stats;
+    StandInCsms csms {(uint32_t) (delayMs * 1000UL), heartbeatS};
+
+    std::vector<std::unique_ptr<SimCharger>> chargers;
+    chargers.reserve(nChargers);
+    for (int i = 0; i < nChargers; i++) {
+        chargers.emplace_back(new SimCharger(i, script, stats));
+    }
+
+    printf("started %d charge points; running for %d s\n", nChargers, durationS);
+
+    const uint64_t startUs = nowUs();
+    const uint64_t endUs = startUs + (uint64_t) durationS * 1000000ULL;
+    uint64_t nextProgressUs = startUs + SIM_PROGRESS_INTERVAL_S * 1000000ULL;
+    uint64_t progressFrames = 0;
+
+    uint64_t now;
+    while ((now = nowUs()) < endUs) {
+        uint64_t framesBefore = stats.getFrames();
+        unsigned long nowMs = ao_tick_ms();
+        unsigned long sleepMs = SIM_MAX_SLEEP_MS;
+
+        for (auto charger = chargers.begin(); charger != chargers.end(); charger++) {
+            (*charger)->runScript(nowMs);
+            (*charger)->loopEngine();
+
+            auto& outbox = (*charger)->getSocket().getOutbox();
+            while (!outbox.empty()) {
+                csms.receive((*charger)->getSocket(), outbox.front());
+                outbox.pop_front();
+            }
+
+            sleepMs = std::min(sleepMs, (*charger)->nextWakeupMs(nowMs));
+            uint64_t due = (*charger)->getSocket().getNextDueUs();
+            if (due) {
+                sleepMs = std::min(sleepMs, due > now ? (unsigned long) ((due - now) / 1000ULL) : 0UL);
+            }
+        }
+
+        if (now >= nextProgressUs) {
+            uint64_t frames = stats.getFrames();
+            printf("t=%5.0f s: %.1f msg/s\n", (now - startUs) / 1e6,
+                    (frames - progressFrames) / (double) SIM_PROGRESS_INTERVAL_S);
+            progressFrames = frames;
+            nextProgressUs += SIM_PROGRESS_INTERVAL_S * 1000000ULL;
+        }
+
+        if (stats.getFrames() == framesBefore && sleepMs > 0) {
+            usleep(sleepMs * 1000UL);
+        }
+    }
+
+    std::vector<uint64_t> engineCpuNs;
+    engineCpuNs.reserve(chargers.size());
+    for (auto charger = chargers.begin(); charger != chargers.end(); charger++) {
+        engineCpuNs.push_back((*charger)->getEngineCpuNs());
+    }
+
+    stats.print((nowUs() - startUs) / 1e6, engineCpuNs);
+
+    return 0;
+}
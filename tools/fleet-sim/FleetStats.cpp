@@ -0,0 +1,71 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include "FleetStats.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#include <algorithm>
+
+namespace FleetSim {
+
+uint64_t nowUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000ULL + (uint64_t) ts.tv_nsec / 1000ULL;
+}
+
+uint64_t threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+namespace {
+
+double percentile(const std::vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.;
+    }
+    size_t index = (size_t) (p * (double) (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.;
+}
+
+} //end anonymous namespace
+
+void FleetStats::print(double elapsedS, const std::vector<uint64_t>& engineCpuNs) const {
+    if (elapsedS <= 0.) {
+        elapsedS = 1e-9;
+    }
+
+    printf("\n=== fleet summary: %zu charge points, %.1f s ===\n", engineCpuNs.size(), elapsedS);
+    printf("frames: %llu tx / %llu rx (%.1f msg/s), bytes: %llu tx / %llu rx\n",
+            (unsigned long long) framesTx, (unsigned long long) framesRx, (framesTx + framesRx) / elapsedS,
+            (unsigned long long) bytesTx, (unsigned long long) bytesRx);
+
+    printf("\n%-28s %8s %9s %9s %9s %9s\n", "latency [ms]", "count", "p50", "p90", "p99", "max");
+    for (auto entry = latencyUs.begin(); entry != latencyUs.end(); entry++) {
+        std::vector<uint32_t> sorted = entry->second;
+        std::sort(sorted.begin(), sorted.end());
+        printf("%-28s %8zu %9.2f %9.2f %9.2f %9.2f\n", entry->first.c_str(), sorted.size(),
+                percentile(sorted, 0.5), percentile(sorted, 0.9), percentile(sorted, 0.99), percentile(sorted, 1.));
+    }
+
+    if (engineCpuNs.empty()) {
+        return;
+    }
+
+    uint64_t total = 0, max = 0;
+    for (auto cpu = engineCpuNs.begin(); cpu != engineCpuNs.end(); cpu++) {
+        total += *cpu;
+        max = std::max(max, *cpu);
+    }
+    double meanMs = total / 1e6 / engineCpuNs.size();
+
+    printf("\nengine CPU: total %.1f ms (%.2f %% of one core), per charge point: mean %.3f ms, max %.3f ms, mean %.1f us/s\n",
+            total / 1e6, total / 1e7 / elapsedS, meanMs, max / 1e6, meanMs * 1000. / elapsedS);
+}
+
+} //end namespace FleetSim
@@ -0,0 +1,40 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef FLEETSTATS_H
+#define FLEETSTATS_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace FleetSim {
+
+uint64_t nowUs(); //monotonic wall clock
+uint64_t threadCpuNs(); //CPU time of the calling thread
+
+/*
+ * Counters of one simulation run. All samples are kept, so that the percentiles are exact
+ */
+class FleetStats {
+private:
+    std::map<std::string, std::vector<uint32_t>> latencyUs; //key: action; round trip from sendTXT() to the delivery of the response
+    uint64_t framesTx = 0; //charge point -> CSMS
+    uint64_t framesRx = 0; //CSMS -> charge point
+    uint64_t bytesTx = 0;
+    uint64_t bytesRx = 0;
+public:
+    void recordTx(size_t len) {framesTx++; bytesTx += len;}
+    void recordRx(size_t len) {framesRx++; bytesRx += len;}
+    void recordLatency(const std::string& action, uint32_t us) {latencyUs[action].push_back(us);}
+
+    uint64_t getFrames() const {return framesTx + framesRx;}
+
+    void print(double elapsedS, const std::vector<uint64_t>& engineCpuNs) const;
+};
+
+} //end namespace FleetSim
+
+#endif
@@ -0,0 +1,165 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include "SimCharger.h"
+#include "FleetStats.h"
+
+#include <ArduinoOcpp/Core/OcppModel.h>
+#include <ArduinoOcpp/Core/OcppOperation.h>
+#include <ArduinoOcpp/Core/OcppOperationTimeout.h>
+#include <ArduinoOcpp/SimpleOcppOperationFactory.h>
+#include <ArduinoOcpp/MessagesV16/Authorize.h>
+#include <ArduinoOcpp/MessagesV16/BootNotification.h>
+#include <ArduinoOcpp/Tasks/ChargePointStatus/ChargePointStatusService.h>
+#include <ArduinoOcpp/Tasks/ChargePointStatus/ConnectorStatus.h>
+#include <ArduinoOcpp/Tasks/Heartbeat/HeartbeatService.h>
+#include <ArduinoOcpp/Tasks/Metering/MeteringService.h>
+#include <ArduinoOcpp/Tasks/FirmwareManagement/FirmwareService.h>
+#include <ArduinoOcpp/Tasks/Diagnostics/DiagnosticsService.h>
+#include <ArduinoOcpp/Platform.h>
+
+#include <stdio.h>
+#include <algorithm>
+#include <string.h>
+
+#define SIM_NUMCONNECTORS 2
+#define SIM_CONNECTOR_ID 1
+#define SIM_POWER_W 11000.f
+
+using namespace ArduinoOcpp;
+
+namespace FleetSim {
+
+SimCharger::SimCharger(int index, const CycleScript& script, FleetStats& stats)
+        : index(index), script(script), socket(stats) {
+
+    snprintf(idTag, sizeof(idTag), "FLEET%06d", index);
+
+    char pathPrefix [24];
+    snprintf(pathPrefix, sizeof(pathPrefix), "/cp%d", index);
+    configurationStore = std::make_shared<ConfigurationStore>(pathPrefix);
+    configurationStore->init(FilesystemOpt::Deactivate);
+
+    engine.reset(new OcppEngine(socket, Clocks::DEFAULT_CLOCK, configurationStore));
+    auto& model = engine->getOcppModel();
+
+    model.setChargePointStatusService(std::unique_ptr<ChargePointStatusService>(
+        new ChargePointStatusService(*engine, SIM_NUMCONNECTORS)));
+    model.setHeartbeatService(std::unique_ptr<HeartbeatService>(
+        new HeartbeatService(*engine)));
+    model.setFirmwareService(std::unique_ptr<FirmwareService>(
+        new FirmwareService(*engine)));
+    model.setDiagnosticsService(std::unique_ptr<DiagnosticsService>(
+        new DiagnosticsService(*engine)));
+    model.setMeteringSerivce(std::unique_ptr<MeteringService>(
+        new MeteringService(*engine, SIM_NUMCONNECTORS)));
+
+    *configurationStore->declareConfiguration<int>("MeterValueSampleInterval", 60) = script.meterValueSampleInterval;
+
+    model.getMeteringService()->setPowerSampler(SIM_CONNECTOR_ID, [this] () {return readPower();});
+    model.getMeteringService()->setEnergySampler(SIM_CONNECTOR_ID, [this] () {return readEnergy();});
+
+    auto connector = model.getConnectorStatus(SIM_CONNECTOR_ID);
+    connector->setConnectorPluggedSampler([this] () {return plugged;});
+    connector->setEvRequestsEnergySampler([this] () {return plugged;});
+    connector->setConnectorEnergizedSampler([this] () {return isCharging();});
+
+    engine->setRunOcppTasks(false); //like OCPP_initialize(): wait for the BootNotification.conf
+
+    auto bootNotification = makeOcppOperation(new Ocpp16::BootNotification("FleetSim", "ArduinoOcpp"));
+    bootNotification->setTimeout(std::unique_ptr<Timeout>(new SuppressedTimeout()));
+    engine->initiateOperation(std::move(bootNotification));
+}
+
+SimCharger::~SimCharger() = default;
+
+bool SimCharger::isCharging() {
+    auto connector = engine->getOcppModel().getConnectorStatus(SIM_CONNECTOR_ID);
+    return plugged && connector && connector->getTransactionId() > 0;
+}
+
+float SimCharger::readPower() {
+    return isCharging() ? SIM_POWER_W : 0.f;
+}
+
+float SimCharger::readEnergy() {
+    unsigned long now = ao_tick_ms();
+    energyWh += readPower() * (float) (now - lastEnergyUpdate) / 3600000.f;
+    lastEnergyUpdate = now;
+    return energyWh;
+}
+
+void SimCharger::runScript(unsigned long now) {
+    auto& model = engine->getOcppModel();
+
+    switch (phase) {
+        case Phase::Booting:
+            if (model.getChargePointStatusService()->isBooted()) {
+                engine->setRunOcppTasks(true);
+                phase = Phase::Idle;
+                nextEvent = now + (index * 7919UL) % (script.idleMs + 1); //spread the fleet over one idle period
+            }
+            break;
+        case Phase::Idle:
+            if ((long) (now - nextEvent) >= 0) {
+                plugged = true;
+                sessionStarted = false;
+                authorizationFailed = false;
+
+                auto authorize = makeOcppOperation(new Ocpp16::Authorize(idTag));
+                authorize->setOnReceiveConfListener([this] (JsonObject payload) {
+                    if (!strcmp(payload["idTagInfo"]["status"] | "Invalid", "Accepted")) {
+                        engine->getOcppModel().getConnectorStatus(SIM_CONNECTOR_ID)->beginSession(idTag);
+                        sessionStarted = true;
+                    } else {
+                        authorizationFailed = true;
+                    }
+                });
+                authorize->setOnAbortListener([this] () {
+                    authorizationFailed = true;
+                });
+                authorize->setTimeout(std::unique_ptr<Timeout>(new FixedTimeout(20000)));
+                engine->initiateOperation(std::move(authorize));
+                phase = Phase::Authorizing;
+            }
+            break;
+        case Phase::Authorizing:
+            if (sessionStarted) {
+                phase = Phase::Charging;
+                nextEvent = now + script.chargeMs;
+            } else if (authorizationFailed) {
+                plugged = false;
+                phase = Phase::Idle;
+                nextEvent = now + script.idleMs;
+            }
+            break;
+        case Phase::Charging:
+            if ((long) (now - nextEvent) >= 0) {
+                model.getConnectorStatus(SIM_CONNECTOR_ID)->endSession();
+                plugged = false;
+                phase = Phase::Idle;
+                nextEvent = now + script.idleMs;
+            }
+            break;
+    }
+}
+
+void SimCharger::loopEngine() {
+    uint64_t start = threadCpuNs();
+    engine->loop();
+    engineCpuNs += threadCpuNs() - start;
+}
+
+unsigned long SimCharger::nextWakeupMs(unsigned long now) {
+    unsigned long wakeup = engine->nextWakeupMs();
+
+    if (phase == Phase::Idle || phase == Phase::Charging) {
+        long untilEvent = (long) (nextEvent - now);
+        wakeup = std::min(wakeup, untilEvent > 0 ? (unsigned long) untilEvent : 0UL);
+    } //Booting and Authorizing continue after a response, which the simulation loop handles
+
+    return wakeup;
+}
+
+} //end namespace FleetSim
@@ -0,0 +1,67 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef SIMCHARGER_H
+#define SIMCHARGER_H
+
+#include "SimSocket.h"
+
+#include <ArduinoOcpp/Core/OcppEngine.h>
+#include <ArduinoOcpp/Core/Configuration.h>
+
+#include <memory>
+
+namespace FleetSim {
+
+struct CycleScript {
+    unsigned long idleMs; //time between unplugging and the next plug-in
+    unsigned long chargeMs; //duration of the charging session after the authorization
+    int meterValueSampleInterval; //in s
+};
+
+/*
+ * One simulated charge point: a real OcppEngine with its own configuration store and synthetic samplers. The
+ * script runs plug-in / authorize / charge / unplug cycles on connector 1
+ */
+class SimCharger {
+private:
+    enum class Phase {Booting, Idle, Authorizing, Charging};
+
+    const int index;
+    const CycleScript script;
+    char idTag [21];
+
+    SimSocket socket;
+    std::shared_ptr<ArduinoOcpp::ConfigurationStore> configurationStore;
+    std::unique_ptr<ArduinoOcpp::OcppEngine> engine;
+
+    Phase phase = Phase::Booting;
+    unsigned long nextEvent = 0;
+    bool plugged = false;
+    bool sessionStarted = false;
+    bool authorizationFailed = false;
+
+    float energyWh = 0.f;
+    unsigned long lastEnergyUpdate = 0;
+
+    uint64_t engineCpuNs = 0;
+
+    bool isCharging();
+    float readPower();
+    float readEnergy();
+public:
+    SimCharger(int index, const CycleScript& script, FleetStats& stats);
+    ~SimCharger();
+
+    void runScript(unsigned long now); //advance the plug-in / charge / unplug cycle
+    void loopEngine(); //runs OcppEngine::loop() and accounts its CPU time
+
+    SimSocket& getSocket() {return socket;}
+    uint64_t getEngineCpuNs() const {return engineCpuNs;}
+    unsigned long nextWakeupMs(unsigned long now);
+};
+
+} //end namespace FleetSim
+
+#endif
@@ -0,0 +1,42 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include "SimSocket.h"
+#include "FleetStats.h"
+
+namespace FleetSim {
+
+void SimSocket::loop() {
+    uint64_t now = nowUs();
+
+    while (!inbox.empty() && inbox.front().dueUs <= now) {
+        Frame& frame = inbox.front();
+
+        if (!receiveTXT || !receiveTXT(frame.text.c_str(), frame.text.length())) {
+            break; //engine is busy, try again in the next loop
+        }
+
+        stats.recordRx(frame.text.length());
+        if (!frame.action.empty()) {
+            stats.recordLatency(frame.action, (uint32_t) (nowUs() - frame.sentUs));
+        }
+        inbox.pop_front();
+    }
+}
+
+bool SimSocket::sendTXT(std::string &out) {
+    Frame frame;
+    frame.text = out;
+    frame.sentUs = nowUs();
+    frame.dueUs = 0;
+    outbox.push_back(std::move(frame));
+    stats.recordTx(out.length());
+    return true;
+}
+
+uint64_t SimSocket::getNextDueUs() const {
+    return inbox.empty() ? 0 : inbox.front().dueUs;
+}
+
+} //end namespace FleetSim
@@ -0,0 +1,54 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef SIMSOCKET_H
+#define SIMSOCKET_H
+
+#include <ArduinoOcpp/Core/OcppSocket.h>
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+
+namespace FleetSim {
+
+class FleetStats;
+
+/*
+ * In-process replacement of the WebSocket. Outgoing frames are queued until the simulation loop hands them to the
+ * stand-in CSMS, so that the CSMS work doesn't count as engine CPU time. Incoming frames are delivered by loop(),
+ * i.e. inside OcppEngine::loop()
+ */
+class SimSocket : public ArduinoOcpp::OcppSocket {
+public:
+    struct Frame {
+        std::string text;
+        uint64_t sentUs; //time when the peer has sent the request or response
+        uint64_t dueUs; //incoming frames only: time of delivery, which models the network and CSMS delay
+        std::string action; //incoming CALLRESULTs only: action of the answered request for the latency statistics
+    };
+private:
+    FleetStats& stats;
+    ArduinoOcpp::ReceiveTXTcallback receiveTXT;
+    std::deque<Frame> inbox;
+    std::deque<Frame> outbox;
+public:
+    SimSocket(FleetStats& stats) : stats(stats) { }
+
+    void loop();
+
+    bool sendTXT(std::string &out);
+
+    void setReceiveTXTcallback(ArduinoOcpp::ReceiveTXTcallback &receiveTXT) {this->receiveTXT = receiveTXT;}
+
+    void deliver(Frame frame) {inbox.push_back(std::move(frame));}
+
+    std::deque<Frame>& getOutbox() {return outbox;}
+
+    uint64_t getNextDueUs() const; //0 if the inbox is empty
+};
+
+} //end namespace FleetSim
+
+#endif
@@ -0,0 +1,62 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#include "StandInCsms.h"
+#include "FleetStats.h"
+
+#include <string.h>
+#include <time.h>
+
+namespace FleetSim {
+
+StandInCsms::StandInCsms(uint32_t responseDelayUs, int heartbeatInterval)
+        : responseDelayUs(responseDelayUs), heartbeatInterval(heartbeatInterval) {
+    updateCurrentTime();
+}
+
+void StandInCsms::updateCurrentTime() {
+    time_t now = time(nullptr);
+    struct tm utc;
+    gmtime_r(&now, &utc);
+    strftime(currentTime, sizeof(currentTime), "%Y-%m-%dT%H:%M:%S.000Z", &utc);
+}
+
+void StandInCsms::receive(SimSocket& socket, const SimSocket::Frame& frame) {
+    DeserializationError err = deserializeJson(request, frame.text);
+    if (err || (request[0] | 0) != 2) {
+        return; //only answer CALLs
+    }
+
+    const char *msgId = request[1] | "";
+    const char *action = request[2] | "";
+
+    response.clear();
+    response.add(3);
+    response.add(msgId);
+    JsonObject payload = response.createNestedObject();
+
+    if (!strcmp(action, "BootNotification")) {
+        updateCurrentTime();
+        payload["status"] = "Accepted";
+        payload["currentTime"] = (const char*) currentTime;
+        payload["interval"] = heartbeatInterval;
+    } else if (!strcmp(action, "Heartbeat")) {
+        updateCurrentTime();
+        payload["currentTime"] = (const char*) currentTime;
+    } else if (!strcmp(action, "Authorize") || !strcmp(action, "StopTransaction")) {
+        payload.createNestedObject("idTagInfo")["status"] = "Accepted";
+    } else if (!strcmp(action, "StartTransaction")) {
+        payload["transactionId"] = ++transactionIdCounter;
+        payload.createNestedObject("idTagInfo")["status"] = "Accepted";
+    } //StatusNotification, MeterValues, DataTransfer etc.: empty payload
+
+    SimSocket::Frame out;
+    serializeJson(response, out.text);
+    out.sentUs = frame.sentUs;
+    out.dueUs = nowUs() + responseDelayUs;
+    out.action = action;
+    socket.deliver(std::move(out));
+}
+
+} //end namespace FleetSim
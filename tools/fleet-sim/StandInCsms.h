@@ -0,0 +1,38 @@
+// matth-x/ArduinoOcpp
+// Copyright Matthias Akstaller 2019 - 2022
+// MIT License
+
+#ifndef STANDINCSMS_H
+#define STANDINCSMS_H
+
+#include "SimSocket.h"
+
+#include <ArduinoJson.h>
+
+#include <stdint.h>
+
+namespace FleetSim {
+
+/*
+ * Minimal central system which accepts everything. It answers each CALL with a canned CALLRESULT after a fixed
+ * delay and ignores CALLRESULTs and CALLERRORs of the charge points
+ */
+class StandInCsms {
+private:
+    uint32_t responseDelayUs;
+    int heartbeatInterval;
+    int transactionIdCounter = 0;
+    DynamicJsonDocument request {4096};
+    DynamicJsonDocument response {1024};
+    char currentTime [32];
+
+    void updateCurrentTime();
+public:
+    StandInCsms(uint32_t responseDelayUs, int heartbeatInterval);
+
+    void receive(SimSocket& socket, const SimSocket::Frame& frame);
+};
+
+} //end namespace FleetSim
+
+#endif